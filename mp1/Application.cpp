@@ -50,6 +50,7 @@ Application::Application(char *infile) {
 	srand (time(NULL));
 	par->setparams(infile);
 	log = new Log(par);
+	metrics = new Metrics(par, log);
 	en = new EmulNet(par);
 	mp1 = (MP1Node **) malloc(par->EN_GPSZ * sizeof(MP1Node *));
 
@@ -63,7 +64,7 @@ Application::Application(char *infile) {
 		Address joinaddr;
 		joinaddr = getjoinaddr();
 		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
-		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
+		mp1[i] = new MP1Node(memberNode, par, en, log, metrics, addressOfMemberNode);
 		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
 		delete addressOfMemberNode;
 	}
@@ -73,6 +74,7 @@ Application::Application(char *infile) {
  * Destructor
  */
 Application::~Application() {
+	delete metrics;
 	delete log;
 	delete en;
 	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
@@ -103,6 +105,9 @@ int Application::run()
 		fail();
 	}
 
+	// Export the membership metrics of the run
+	metrics->report();
+
 	// Clean up
 	en->ENcleanup();
 
@@ -143,6 +148,7 @@ void Application::mp1Run() {
 		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
 			// introduce the ith node into the system at time STEPRATE*i
 			mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
+			metrics->nodeStarted(&mp1[i]->getMemberNode()->addr);
 			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
 			nodeCount += i;
 		}
@@ -183,6 +189,10 @@ void Application::fail() {
 		#ifdef DEBUGLOG
 		log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 		#endif
+		metrics->nodeFailed(&mp1[removed]->getMemberNode()->addr);
+		if( par->GRACEFUL_LEAVE ) {
+			mp1[removed]->leaveGroup();
+		}
 		mp1[removed]->getMemberNode()->bFailed = true;
 	}
 	else if( par->getcurrtime() == 100 ) {
@@ -191,6 +201,10 @@ void Application::fail() {
 			#ifdef DEBUGLOG
 			log->LOG(&mp1[i]->getMemberNode()->addr, "Node failed at time = %d", par->getcurrtime());
 			#endif
+			metrics->nodeFailed(&mp1[i]->getMemberNode()->addr);
+			if( par->GRACEFUL_LEAVE ) {
+				mp1[i]->leaveGroup();
+			}
 			mp1[i]->getMemberNode()->bFailed = true;
 		}
 	}
@@ -204,7 +218,7 @@ void Application::fail() {
 /**
  * FUNCTION NAME: getjoinaddr
  *
- * DESCRIPTION: This function returns the address of the coordinator
+ * DESCRIPTION: This function returns the address of the group booter, the first of the NUM_SEEDS seeds
  */
 Address Application::getjoinaddr(void){
 	//trace.funcEntry("Application::getjoinaddr");
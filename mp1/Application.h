@@ -14,6 +14,7 @@
 #include "Member.h"
 #include "EmulNet.h"
 #include "Queue.h"
+#include "Metrics.h"
 
 /**
  * global variables
@@ -38,6 +39,7 @@ private:
 	char JOINADDR[30];
 	EmulNet *en;
     Log *log;
+	Metrics *metrics;
 	MP1Node **mp1;
 	Params *par;
 public:
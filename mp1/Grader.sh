@@ -187,4 +187,125 @@ fi
 #	echo "Checking Accuracy..............0/10"
 #fi
 #echo "============================================"
+echo "============================================"
+echo "Graceful Leave Scenario"
+echo "============================"
+if [ $verbose -eq 0 ]; then
+	make clean > /dev/null
+	make > /dev/null
+	./Application testcases/gracefulleave.conf > /dev/null
+else
+	make clean
+	make
+	./Application testcases/gracefulleave.conf
+fi
+joincount=`grep joined dbg.log | cut -d" " -f2,4-7 | sort -u | wc -l`
+if [ $joincount -eq 100 ]; then
+	grade=`expr $grade + 10`
+	echo "Checking Join..................10/10"
+else
+	joinfrom=`grep joined dbg.log | cut -d" " -f2 | sort -u`
+	cnt=0
+	for i in $joinfrom
+	do
+		jointo=`grep joined dbg.log | grep '^ '$i | cut -d" " -f4-7 | grep -v $i | sort -u | wc -l`
+		if [ $jointo -eq 9 ]; then
+			cnt=`expr $cnt + 1`
+		fi
+	done
+	if [ $cnt -eq 10 ]; then
+		grade=`expr $grade + 10`
+		echo "Checking Join..................10/10"
+	else
+		echo "Checking Join..................0/10"
+	fi
+fi
+failednode=`grep "Node failed at time" dbg.log | sort -u | awk '{print $1}'`
+tmp=0
+cnt=0
+for i in $failednode
+do
+	failcount=`grep removed dbg.log | sort -u | grep $i | wc -l`
+	if [ $failcount -ge 5 ]; then
+		tmp=`expr $tmp + 2`
+		grade=`expr $grade + 2`
+	fi
+        cnt=`expr $cnt + 1`
+        if [ $cnt -gt 5 ]; then
+                break
+        fi
+done
+echo "Checking Completeness..........$tmp/10"
+failednode=`grep "Node failed at time" dbg.log | sort -u | awk '{print $1}'`
+tmp=0
+for i in $failednode
+do
+	accuracycount=`grep removed dbg.log | sort -u | grep -v $i | wc -l`
+	if [ $accuracycount -eq 20 ]; then
+		tmp=`expr $tmp + 2`
+		grade=`expr $grade + 2`
+	fi
+        if [ $tmp -gt 9 ]; then
+                break
+        fi
+done
+echo "Checking Accuracy..............$tmp/10"
+failtime=`grep "Node failed at time" dbg.log | head -1 | awk '{print $NF}'`
+lasttime=`grep removed dbg.log | awk '{print $NF}' | sort -n | tail -1`
+# a node that leaves is removed as soon as its LEAVE has spread, well before TFAIL
+if [ -n "$lasttime" ] && [ `expr $lasttime - $failtime` -le 5 ]; then
+	grade=`expr $grade + 10`
+	echo "Checking Leave Latency.........10/10"
+else
+	echo "Checking Leave Latency.........0/10"
+fi
+echo "============================================"
+echo "Multiple Seeds Single Failure Scenario"
+echo "============================"
+if [ $verbose -eq 0 ]; then
+	make clean > /dev/null
+	make > /dev/null
+	./Application testcases/multipleseeds.conf > /dev/null
+else
+	make clean
+	make
+	./Application testcases/multipleseeds.conf
+fi
+joincount=`grep joined dbg.log | cut -d" " -f2,4-7 | sort -u | wc -l`
+if [ $joincount -eq 100 ]; then
+	grade=`expr $grade + 10`
+	echo "Checking Join..................10/10"
+else
+	joinfrom=`grep joined dbg.log | cut -d" " -f2 | sort -u`
+	cnt=0
+	for i in $joinfrom
+	do
+		jointo=`grep joined dbg.log | grep '^ '$i | cut -d" " -f4-7 | grep -v $i | sort -u | wc -l`
+		if [ $jointo -eq 9 ]; then
+			cnt=`expr $cnt + 1`
+		fi
+	done
+	if [ $cnt -eq 10 ]; then
+		grade=`expr $grade + 10`
+		echo "Checking Join..................10/10"
+	else
+		echo "Checking Join..................0/10"
+	fi
+fi
+failednode=`grep "Node failed at time" dbg.log | sort -u | awk '{print $1}'`
+failcount=`grep removed dbg.log | sort -u | grep $failednode | wc -l`
+if [ $failcount -ge 9 ]; then
+	grade=`expr $grade + 10`
+	echo "Checking Completeness..........10/10"
+else
+	echo "Checking Completeness..........0/10"
+fi
+failednode=`grep "Node failed at time" dbg.log | sort -u | awk '{print $1}'`
+accuracycount=`grep removed dbg.log | sort -u | grep -v $failednode | wc -l`
+if [ $accuracycount -eq 0 ] && [ $failcount -gt 0 ]; then
+	grade=`expr $grade + 10`
+	echo "Checking Accuracy..............10/10"
+else
+	echo "Checking Accuracy..............0/10"
+fi
 echo Final grade $grade
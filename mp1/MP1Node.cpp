@@ -5,8 +5,6 @@
  * 				Definition of MP1Node class functions.
  **********************************/
 
-#include <unordered_set>
-#include <random>
 #include "MP1Node.h"
 
 #define HEARTBEAT_RECEIVERS_FACTOR 0.6
@@ -20,15 +18,21 @@
  * You can add new members to the class if you think it
  * is necessary for your logic to work
  */
-MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Address *address) {
+MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Metrics *metrics, Address *address)
+        : expiryWheel(EXPIRY_WHEEL_SLOTS) {
     for (int i = 0; i < 6; i++) {
         NULLADDR[i] = 0;
     }
     this->memberNode = member;
     this->emulNet = emul;
     this->log = log;
+    this->metrics = metrics;
     this->par = params;
     this->memberNode->addr = *address;
+    this->selfId = *(int *) (&memberNode->addr.addr);
+    this->joinAttempts = 0;
+    this->joinRequestTime = 0;
+    this->rng.seed(static_cast<unsigned int>(std::rand()));
 }
 
 /**
@@ -110,10 +114,12 @@ int MP1Node::initThisNode(Address *joinaddr) {
     memberNode->heartbeat = 0;
     memberNode->pingCounter = TFAIL;
     memberNode->timeOutCounter = -1;
+    joinAttempts = 0;
     initMemberListTable(memberNode);
+    expiryWheel.reset(par->getcurrtime());
 
-    memberNode->memberList.emplace_back(id, port, memberNode->heartbeat, par->getcurrtime());
-    memberNode->myPos = memberNode->memberList.begin();
+    // my own entry is never scheduled for expiry
+    memberNode->memberList.insert(MemberListEntry(id, port, memberNode->heartbeat, par->getcurrtime()));
 
     return 0;
 }
@@ -149,7 +155,9 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
 #endif
 
         // send JOINREQ message to introducer member
-        emulNet->ENsend(&memberNode->addr, joinaddr, (char *) msg, static_cast<int>(msgsize));
+        sendMessage(joinaddr, (char *) msg, static_cast<int>(msgsize));
+        joinAttempts++;
+        joinRequestTime = par->getcurrtime();
 
         free(msg);
     }
@@ -158,15 +166,38 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
 
 }
 
+/**
+ * FUNCTION NAME: leaveGroup
+ *
+ * DESCRIPTION: Announce the leave of this node, so that peers drop it right away instead of
+ * 				waiting for TREMOVE, and wind it up
+ */
+void MP1Node::leaveGroup() {
+    if (!memberNode->inited || memberNode->bFailed || !memberNode->inGroup) {
+        return;
+    }
+
+    memberNode->heartbeat++;
+    MemberListEntry self = memberNode->memberList.entry(findMember(selfId));
+    self.setheartbeat(memberNode->heartbeat);
+    // told to every member directly, a gossiped LEAVE may only reach nodes that are leaving too
+    gossipLeave(self, true);
+
+    finishUpThisNode();
+}
+
 /**
  * FUNCTION NAME: finishUpThisNode
  *
  * DESCRIPTION: Wind up this node and clean up state
  */
 int MP1Node::finishUpThisNode() {
-    /*
-     * Your code goes here
-     */
+    memberNode->inGroup = false;
+    memberNode->inited = false;
+    initMemberListTable(memberNode);
+    expiryWheel.reset(par->getcurrtime());
+    leftMembers.clear();
+
     return 0;
 }
 
@@ -186,6 +217,11 @@ void MP1Node::nodeLoop() {
 
     // Wait until you're in the group...
     if (!memberNode->inGroup) {
+        // ...asking the next seed if the JOINREQ or its JOINREP got lost
+        if (memberNode->inited && par->getcurrtime() - joinRequestTime >= JOIN_TIMEOUT) {
+            Address joinaddr = getJoinAddress();
+            introduceSelfToGroup(&joinaddr);
+        }
         return;
     }
 
@@ -214,40 +250,54 @@ void MP1Node::checkMessages() {
     return;
 }
 
-size_t alreadyContains(int id, const vector<MemberListEntry> &memberList) {
-    size_t i;
-    for (i = 0; i < memberList.size(); ++i) {
-        if (memberList[i].id == id) {
-            return i;
-        }
-    }
-
-    return i;
+size_t member_list_size(size_t count) {
+    return sizeof(size_t) + count * (2 * sizeof(long) + sizeof(int) + sizeof(short));
 }
 
-void serialize_member_list(const vector<MemberListEntry> &memberList, char *buff) {
-    size_t size = memberList.size();
-    memcpy(buff, &size, sizeof(size_t));
-    int ptr = sizeof(size_t);
-    for (int i = 0; i < size; ++i) {
-        memcpy(buff + ptr, &memberList[i], sizeof(MemberListEntry));
-        ptr += sizeof(MemberListEntry);
+// buff has to be long aligned, see MemberListColumns for the layout
+void serialize_member_list(const MembershipTable &memberList, const vector<size_t> &positions, char *buff) {
+    size_t count = positions.size();
+    memcpy(buff, &count, sizeof(size_t));
+    auto heartbeats = (long *) (buff + sizeof(size_t));
+    auto timestamps = heartbeats + count;
+    auto ids = (int *) (timestamps + count);
+    auto ports = (short *) (ids + count);
+    for (size_t i = 0; i < count; ++i) {
+        MemberListEntry entry = memberList.entry(positions[i]);
+        heartbeats[i] = entry.heartbeat;
+        timestamps[i] = entry.timestamp;
+        ids[i] = entry.id;
+        ports[i] = entry.port;
     }
 }
 
-unique_ptr<vector<MemberListEntry>> deserialize_member_list(char *buff, Log *log, int msg_size, Address *addr) {
-    size_t size = 0;
-    memcpy(&size, buff, sizeof(size_t));
-    int ptr = sizeof(size_t);
-    auto member_list = unique_ptr<vector<MemberListEntry>>(new vector<MemberListEntry>());
-    for (size_t i = 0; i < size; ++i) {
-        MemberListEntry memberListEntry = MemberListEntry();
-        memcpy(&memberListEntry, buff + ptr, sizeof(MemberListEntry));
-        member_list->push_back(memberListEntry);
-        ptr += sizeof(MemberListEntry);
-    }
+// a LEAVE carries the member that left as a list of one, without a timestamp
+void serialize_leave(const MemberListEntry &entry, char *buff) {
+    size_t count = 1;
+    memcpy(buff, &count, sizeof(size_t));
+    auto heartbeats = (long *) (buff + sizeof(size_t));
+    auto timestamps = heartbeats + count;
+    auto ids = (int *) (timestamps + count);
+    auto ports = (short *) (ids + count);
+    heartbeats[0] = entry.heartbeat;
+    timestamps[0] = 0;
+    ids[0] = entry.id;
+    ports[0] = entry.port;
+}
 
-    return member_list;
+MemberListColumns read_member_list(const char *buff) {
+    MemberListColumns columns;
+    memcpy(&columns.count, buff, sizeof(size_t));
+    columns.heartbeats = (const long *) (buff + sizeof(size_t));
+    columns.timestamps = columns.heartbeats + columns.count;
+    columns.ids = (const int *) (columns.timestamps + columns.count);
+    columns.ports = (const short *) (columns.ids + columns.count);
+
+    return columns;
+}
+
+MemberListEntry column_entry(const MemberListColumns &columns, size_t i) {
+    return MemberListEntry(columns.ids[i], columns.ports[i], columns.heartbeats[i], columns.timestamps[i]);
 }
 
 Address extractAddress(const MemberListEntry &entry) {
@@ -267,6 +317,11 @@ Address extractAddress(const MemberListEntry &entry) {
 bool MP1Node::recvCallBack(void *env, char *data, int size) {
     auto *hdr = (MessageHdr *) data;
     if (hdr->msgType == JOINREQ) {
+        // a seed that has not joined yet has no list to hand out, the newcomer retries another seed
+        if (!memberNode->inGroup) {
+            return false;
+        }
+
         auto member = unique_ptr<Member>(new Member);
         member->addr = Address();
         member->addr.init();
@@ -276,51 +331,47 @@ bool MP1Node::recvCallBack(void *env, char *data, int size) {
 
         int id = *(int *) (&member->addr.addr);
         short port = *(short *) (&member->addr.addr[4]);
-        size_t entry_index = alreadyContains(id, memberNode->memberList);
-        if (entry_index == memberNode->memberList.size()) {
-            log->logNodeAdd(&memberNode->addr, &member->addr);
-
-            size_t message_size =
-                    sizeof(MessageHdr) + sizeof(size_t) + memberNode->memberList.size() * sizeof(MemberListEntry);
-            auto msg = (MessageHdr *) malloc(message_size * sizeof(char));
-            msg->msgType = JOINREP;
-            serialize_member_list(memberNode->memberList, (char *) (msg + 1));
-            emulNet->ENsend(&memberNode->addr, &member->addr, (char *) msg, static_cast<int>(message_size));
-            memberNode->memberList.emplace_back(id, port, member->heartbeat, par->getcurrtime());
+        // a retried JOINREQ is answered again, its first JOINREP may have been dropped.
+        // Only the members heard from within TFAIL are handed out, the newcomer would add dead ones otherwise
+        memberNode->memberList.findFresh(par->getcurrtime(), TFAIL, selectedMembers);
+        size_t message_size = MEMBER_LIST_OFFSET + member_list_size(selectedMembers.size());
+        auto msg = (MessageHdr *) malloc(message_size * sizeof(char));
+        msg->msgType = JOINREP;
+        serialize_member_list(memberNode->memberList, selectedMembers, (char *) msg + MEMBER_LIST_OFFSET);
+        sendMessage(&member->addr, (char *) msg, static_cast<int>(message_size));
+        free(msg);
 
-            free(msg);
+        if (findMember(id) == memberNode->memberList.size()) {
+            // a member that left may come back with a fresh start
+            leftMembers.erase(id);
+            log->logNodeAdd(&memberNode->addr, &member->addr);
+            metrics->memberAdded(&memberNode->addr, &member->addr);
+            addMember(MemberListEntry(id, port, member->heartbeat, par->getcurrtime()));
         }
 
     } else if (hdr->msgType == JOINREP) {
-        auto member_list = deserialize_member_list((char *) (hdr + 1), log, size, &memberNode->addr);
-        memberNode->inGroup = true;
+        // the answer to a retried JOINREQ, the list of the first one is already in
+        if (memberNode->inGroup) {
+            return false;
+        }
 
-        for (auto entry: *member_list) {
+        MemberListColumns member_list = read_member_list(data + MEMBER_LIST_OFFSET);
+        memberNode->inGroup = true;
 
-            if (alreadyContains(entry.id, memberNode->memberList) == memberNode->memberList.size()) {
-                memberNode->memberList.emplace_back(entry);
+        for (size_t i = 0; i < member_list.count; ++i) {
+            MemberListEntry entry = column_entry(member_list, i);
+            if (findMember(entry.id) == memberNode->memberList.size() && !hasLeft(entry)) {
+                addMember(entry);
                 auto address = extractAddress(entry);
                 log->logNodeAdd(&memberNode->addr, &address);
+                metrics->memberAdded(&memberNode->addr, &address);
             }
         }
     } else if (hdr->msgType == HEARTBEAT) {
-        auto member_list = deserialize_member_list((char *) (hdr + 1), log, size, &memberNode->addr);
-        for (auto entry: *member_list) {
-
-            size_t entry_index = alreadyContains(entry.id, memberNode->memberList);
-            if (entry_index == memberNode->memberList.size()) {
-                if (par->getcurrtime() - entry.timestamp < TFAIL) {
-                    memberNode->memberList.push_back(entry);
-                    auto address = extractAddress(entry);
-                    log->logNodeAdd(&memberNode->addr, &address);
-                }
-            } else {
-                if (memberNode->memberList[entry_index].getheartbeat() < entry.getheartbeat()) {
-                    memberNode->memberList[entry_index].setheartbeat(entry.getheartbeat());
-                    memberNode->memberList[entry_index].settimestamp(par->getcurrtime());
-                }
-            }
-        }
+        mergeMemberList(read_member_list(data + MEMBER_LIST_OFFSET));
+    } else if (hdr->msgType == LEAVE) {
+        MemberListColumns member_list = read_member_list(data + MEMBER_LIST_OFFSET);
+        handleLeave(MemberListEntry(member_list.ids[0], member_list.ports[0], member_list.heartbeats[0], 0));
     }
 
     return true;
@@ -338,55 +389,163 @@ void MP1Node::nodeLoopOps() {
         return;
     }
 
-    auto it = memberNode->memberList.begin()++;
-    while (it != memberNode->memberList.end()) {
-        MemberListEntry &entry = *it;
-        long diff = par->getcurrtime() - entry.timestamp;
-        if (diff > TREMOVE) {
-            auto address = extractAddress(entry);
-            log->logNodeRemove(&memberNode->addr, &address);
-            it = memberNode->memberList.erase(it);
-        } else {
-            ++it;
-        }
+    expireMembers();
+
+    memberNode->timeOutCounter = par->getcurrtime();
+    memberNode->heartbeat++;
+    memberNode->memberList.update(findMember(selfId), memberNode->heartbeat, par->getcurrtime());
+
+    // suspected members are left out, spreading their stale heartbeats could only delay their removal
+    memberNode->memberList.findFresh(par->getcurrtime(), TFAIL, selectedMembers);
+    auto message_size = static_cast<int>(MEMBER_LIST_OFFSET + member_list_size(selectedMembers.size()));
+
+    // only grows with the member list, so steady state rounds do not allocate
+    if (gossipBuffer.size() < static_cast<size_t>(message_size)) {
+        gossipBuffer.resize(message_size);
     }
+    auto msg = (MessageHdr *) gossipBuffer.data();
+    msg->msgType = HEARTBEAT;
+    serialize_member_list(memberNode->memberList, selectedMembers, (char *) msg + MEMBER_LIST_OFFSET);
+    gossip(msg, message_size);
+}
 
-    auto size = static_cast<size_t>(max<long>((lround(memberNode->memberList.size() * HEARTBEAT_RECEIVERS_FACTOR)), 2));
-    auto heartbeatReceivers = vector<MemberListEntry>();
-    for (auto &entry: memberNode->memberList) {
-        if (&entry == &memberNode->memberList[0] || par->getcurrtime() - entry.gettimestamp() > TFAIL) {
+/**
+ * FUNCTION NAME: mergeMemberList
+ *
+ * DESCRIPTION: Merges a gossiped membership list into mine. Both lists are sorted by id, so a single
+ * 				merge join pairs them up. Runs of ids present on both sides are merged with
+ * 				mergeMaxHeartbeat straight from the message. Unknown members are only added after
+ * 				the join, as inserting moves the rows. Steady state merges do not allocate.
+ */
+void MP1Node::mergeMemberList(const MemberListColumns &incoming) {
+    MembershipTable &memberList = memberNode->memberList;
+    updatedMembers.clear();
+    unknownMembers.clear();
+
+    size_t i = 0;
+    size_t j = 0;
+    while (j < incoming.count) {
+        while (i < memberList.size() && memberList.getid(i) < incoming.ids[j]) {
+            ++i;
+        }
+        if (i == memberList.size() || memberList.getid(i) != incoming.ids[j]) {
+            unknownMembers.push_back(j++);
             continue;
         }
 
-        heartbeatReceivers.push_back(entry);
+        size_t run = 1;
+        while (i + run < memberList.size() && j + run < incoming.count &&
+               memberList.getid(i + run) == incoming.ids[j + run]) {
+            ++run;
+        }
+        memberList.mergeMaxHeartbeat(i, incoming.heartbeats + j, run, par->getcurrtime(), updatedMembers);
+        i += run;
+        j += run;
     }
 
-    while (heartbeatReceivers.size() > size) {
-        //TODO: replace with c++11 random
-        size_t index = std::rand() % heartbeatReceivers.size();
-        swap(heartbeatReceivers[index], heartbeatReceivers.back());
-        heartbeatReceivers.pop_back();
+    for (size_t position: updatedMembers) {
+        scheduleExpiry(memberList.getid(position), memberList.gettimestamp(position));
     }
 
-    memberNode->timeOutCounter = par->getcurrtime();
-    memberNode->heartbeat++;
-    memberNode->memberList[0].setheartbeat(memberNode->heartbeat);
-    memberNode->memberList[0].settimestamp(par->getcurrtime());
+    for (size_t k: unknownMembers) {
+        MemberListEntry entry = column_entry(incoming, k);
+        if (par->getcurrtime() - entry.timestamp < TFAIL && !hasLeft(entry)) {
+            addMember(entry);
+            auto address = extractAddress(entry);
+            log->logNodeAdd(&memberNode->addr, &address);
+            metrics->memberAdded(&memberNode->addr, &address);
+        }
+    }
+}
 
-    int message_size =
-            sizeof(MessageHdr) + sizeof(size_t) + memberNode->memberList.size() * (sizeof(MemberListEntry));
+/**
+ * FUNCTION NAME: gossip
+ *
+ * DESCRIPTION: Send the message to a random subset of the members heard from within TFAIL.
+ * 				The receivers are drawn with a partial Fisher-Yates shuffle of freshMembers:
+ * 				after i steps its first i ids are a uniform sample. Nothing is copied or allocated.
+ */
+void MP1Node::gossip(MessageHdr *msg, int size) {
+    auto receivers = static_cast<size_t>(max<long>((lround(memberNode->memberList.size() * HEARTBEAT_RECEIVERS_FACTOR)), 2));
+    receivers = min(receivers, freshMembers.size());
 
-    auto msg = (MessageHdr *) malloc(message_size * sizeof(char));
-    msg->msgType = HEARTBEAT;
-    serialize_member_list(memberNode->memberList, (char *) (msg + 1));
+    for (size_t i = 0; i < receivers; ++i) {
+        std::uniform_int_distribution<size_t> pick(i, freshMembers.size() - 1);
+        swapFresh(i, pick(rng));
 
-    for (auto &entry: heartbeatReceivers) {
+        auto address = memberNode->memberList.address(findMember(freshMembers[i]));
+        sendMessage(&address, (char *) msg, size);
+    }
+}
+
+/**
+ * FUNCTION NAME: handleLeave
+ *
+ * DESCRIPTION: Drop a member that announced its leave and pass the news on.
+ * 				The first time a LEAVE is seen it is gossiped further, repeats are ignored.
+ */
+void MP1Node::handleLeave(const MemberListEntry &entry) {
+    if (!memberNode->inGroup || hasLeft(entry) || entry.id == selfId) {
+        return;
+    }
+
+    size_t index = findMember(entry.id);
+    if (index != memberNode->memberList.size()) {
         auto address = extractAddress(entry);
+        log->logNodeRemove(&memberNode->addr, &address);
+        metrics->memberRemoved(&memberNode->addr, &address);
+        removeMember(entry.id);
+    }
+
+    // the member is gone from the list, so its id is free in the wheel to time the tombstone out
+    leftMembers[entry.id] = entry.heartbeat;
+    expiryWheel.schedule(entry.id, par->getcurrtime() + TREMOVE);
+
+    gossipLeave(entry, false);
+}
 
-        emulNet->ENsend(&memberNode->addr, &address, (char *) msg, message_size);
+/**
+ * FUNCTION NAME: gossipLeave
+ *
+ * DESCRIPTION: Gossip the LEAVE of the member, or send it to every member heard from within TFAIL
+ * 				with toAll. The message is built in the buffer of the heartbeats.
+ */
+void MP1Node::gossipLeave(const MemberListEntry &entry, bool toAll) {
+    int message_size = static_cast<int>(MEMBER_LIST_OFFSET + member_list_size(1));
+    if (gossipBuffer.size() < static_cast<size_t>(message_size)) {
+        gossipBuffer.resize(message_size);
+    }
+    auto msg = (MessageHdr *) gossipBuffer.data();
+    msg->msgType = LEAVE;
+    serialize_leave(entry, (char *) msg + MEMBER_LIST_OFFSET);
+    if (!toAll) {
+        gossip(msg, message_size);
+        return;
+    }
+    for (int id: freshMembers) {
+        auto address = memberNode->memberList.address(findMember(id));
+        sendMessage(&address, (char *) msg, message_size);
     }
+}
+
+/**
+ * FUNCTION NAME: hasLeft
+ *
+ * DESCRIPTION: Checks if the entry is gossip about a member that has announced its leave since
+ */
+bool MP1Node::hasLeft(const MemberListEntry &entry) {
+    auto it = leftMembers.find(entry.id);
+    return it != leftMembers.end() && it->second >= entry.heartbeat;
+}
 
-    free(msg);
+/**
+ * FUNCTION NAME: sendMessage
+ *
+ * DESCRIPTION: Hand a membership protocol message to the network
+ */
+void MP1Node::sendMessage(Address *toaddr, char *msg, int size) {
+    emulNet->ENsend(&memberNode->addr, toaddr, msg, size);
+    metrics->messageSent(size);
 }
 
 /**
@@ -401,16 +560,38 @@ int MP1Node::isNullAddress(Address *addr) {
 /**
  * FUNCTION NAME: getJoinAddress
  *
- * DESCRIPTION: Returns the Address of the coordinator
+ * DESCRIPTION: Returns the Address of the seed to send the next JOINREQ to.
+ * 				The first seed boots the group and gets its own address back. Every other node starts
+ * 				at the seed picked by its id, which spreads the joins over the seeds, and moves on to
+ * 				the next seed on every retry.
  */
 Address MP1Node::getJoinAddress() {
-    Address joinaddr;
+    int id = *(int *) (&memberNode->addr.addr);
+    if (id == 1) {
+        return getSeedAddress(0);
+    }
 
-    memset(&joinaddr, 0, sizeof(Address));
-    *(int *) (&joinaddr.addr) = 1;
-    *(short *) (&joinaddr.addr[4]) = 0;
+    int seed = (id + joinAttempts) % par->NUM_SEEDS;
+    if (seed + 1 == id) {
+        seed = (seed + 1) % par->NUM_SEEDS;
+    }
 
-    return joinaddr;
+    return getSeedAddress(seed);
+}
+
+/**
+ * FUNCTION NAME: getSeedAddress
+ *
+ * DESCRIPTION: Returns the Address of the given seed. Seeds are the first NUM_SEEDS nodes.
+ */
+Address MP1Node::getSeedAddress(int seed) {
+    Address seedaddr;
+
+    memset(&seedaddr, 0, sizeof(Address));
+    *(int *) (&seedaddr.addr) = seed + 1;
+    *(short *) (&seedaddr.addr[4]) = 0;
+
+    return seedaddr;
 }
 
 /**
@@ -420,6 +601,143 @@ Address MP1Node::getJoinAddress() {
  */
 void MP1Node::initMemberListTable(Member *memberNode) {
     memberNode->memberList.clear();
+    freshMembers.clear();
+    freshIndex.clear();
+}
+
+/**
+ * FUNCTION NAME: findMember
+ *
+ * DESCRIPTION: Returns the position of the member in the membership list, or the list size if it is unknown
+ */
+size_t MP1Node::findMember(int id) {
+    return memberNode->memberList.find(id);
+}
+
+/**
+ * FUNCTION NAME: addMember
+ *
+ * DESCRIPTION: Inserts a new entry into the membership list and arms its expiry
+ */
+void MP1Node::addMember(const MemberListEntry &entry) {
+    memberNode->memberList.insert(entry);
+    scheduleExpiry(entry.id, entry.timestamp);
+}
+
+/**
+ * FUNCTION NAME: removeMember
+ *
+ * DESCRIPTION: Removes the entry from the membership list and disarms its expiry
+ */
+void MP1Node::removeMember(int id) {
+    size_t index = findMember(id);
+    if (index == memberNode->memberList.size()) {
+        return;
+    }
+
+    memberNode->memberList.erase(index);
+    expiryWheel.cancel(id);
+    markSuspected(id);
+}
+
+/**
+ * FUNCTION NAME: scheduleExpiry
+ *
+ * DESCRIPTION: Arms the next deadline of an entry based on its timestamp:
+ * 				a fresh entry is suspected once it is older than TFAIL,
+ * 				a suspected entry is removed once it is older than TREMOVE
+ */
+void MP1Node::scheduleExpiry(int id, long timestamp) {
+    if (id == selfId) {
+        return;
+    }
+
+    if (par->getcurrtime() - timestamp <= TFAIL) {
+        markFresh(id);
+        expiryWheel.schedule(id, timestamp + TFAIL + 1);
+    } else {
+        markSuspected(id);
+        expiryWheel.schedule(id, timestamp + TREMOVE + 1);
+    }
+}
+
+/**
+ * FUNCTION NAME: expireMembers
+ *
+ * DESCRIPTION: Handles the entries whose deadline has passed: suspects the ones older than TFAIL
+ * 				and removes the ones older than TREMOVE. Entries that are not due are not visited.
+ */
+void MP1Node::expireMembers() {
+    expiredMembers.clear();
+    expiryWheel.advance(par->getcurrtime(), expiredMembers);
+
+    for (uint64_t id: expiredMembers) {
+        size_t index = findMember(static_cast<int>(id));
+        if (index == memberNode->memberList.size()) {
+            // tombstone of a member that left
+            leftMembers.erase(static_cast<int>(id));
+            continue;
+        }
+
+        MemberListEntry entry = memberNode->memberList.entry(index);
+        if (par->getcurrtime() - entry.timestamp > TREMOVE) {
+            auto address = extractAddress(entry);
+            log->logNodeRemove(&memberNode->addr, &address);
+            metrics->memberRemoved(&memberNode->addr, &address);
+            removeMember(entry.id);
+        } else {
+            scheduleExpiry(entry.id, entry.timestamp);
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: markFresh
+ *
+ * DESCRIPTION: Adds the member to the set of heartbeat receivers
+ */
+void MP1Node::markFresh(int id) {
+    if (freshIndex.count(id)) {
+        return;
+    }
+
+    freshIndex[id] = freshMembers.size();
+    freshMembers.push_back(id);
+}
+
+/**
+ * FUNCTION NAME: markSuspected
+ *
+ * DESCRIPTION: Removes the member from the set of heartbeat receivers
+ */
+void MP1Node::markSuspected(int id) {
+    auto it = freshIndex.find(id);
+    if (it == freshIndex.end()) {
+        return;
+    }
+
+    size_t index = it->second;
+    freshIndex.erase(it);
+    if (index != freshMembers.size() - 1) {
+        freshMembers[index] = freshMembers.back();
+        freshIndex[freshMembers[index]] = index;
+    }
+    freshMembers.pop_back();
+}
+
+/**
+ * FUNCTION NAME: swapFresh
+ *
+ * DESCRIPTION: Swaps two positions of freshMembers, the order of the set is arbitrary
+ */
+void MP1Node::swapFresh(size_t i, size_t j) {
+    if (i == j) {
+        return;
+    }
+
+    swap(freshMembers[i], freshMembers[j]);
+    freshIndex[freshMembers[i]] = i;
+    freshIndex[freshMembers[j]] = j;
 }
 
 /**
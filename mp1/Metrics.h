@@ -0,0 +1,76 @@
+/**********************************
+ * FILE NAME: Metrics.h
+ *
+ * DESCRIPTION: Header file of Metrics class
+ **********************************/
+
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+#include "Log.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+using std::unordered_map;
+using std::unordered_set;
+
+/**
+ * CLASS NAME: Metrics
+ *
+ * DESCRIPTION: Measures how membership changes propagate through the group.
+ * 				The application reports the ground truth (which node started or failed when),
+ * 				the membership protocol reports what each node observes and how many bytes it sends.
+ * 				For every join and failure the report gives the time until the first node and until
+ * 				all surviving nodes observed it, and the gossip bytes sent until then.
+ * 				Removals of nodes that had not failed are counted as false positives.
+ */
+class Metrics {
+private:
+    struct Change {
+        bool join;
+        int node;
+        int time;
+        long bytesAtChange;
+        // observer id -> (time of the first observation, bytes sent by then)
+        unordered_map<int, pair<int, long>> observations;
+    };
+
+    Params *par;
+    Log *log;
+    vector<Change> changes;
+    // node id -> index of its latest join and failure in changes
+    unordered_map<int, size_t> lastJoin;
+    unordered_map<int, size_t> lastFailure;
+    unordered_set<int> started;
+    unordered_set<int> failed;
+    long bytes;
+    long messages;
+    int falsePositives;
+
+    static int idOf(Address *addr);
+
+    void observe(Change &change, int observer);
+
+public:
+    Metrics(Params *par, Log *log);
+
+    // ground truth, reported by the application
+    void nodeStarted(Address *addr);
+
+    void nodeFailed(Address *addr);
+
+    // observations, reported by the membership protocol
+    void memberAdded(Address *observer, Address *member);
+
+    void memberRemoved(Address *observer, Address *member);
+
+    void messageSent(int size);
+
+    void report();
+};
+
+#endif /* METRICS_H_ */
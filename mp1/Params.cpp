@@ -26,6 +26,20 @@ void Params::setparams(char *config_file) {
 
 	//printf("Parameters of the test case: %d %d %d %lf\n", MAX_NNB, SINGLE_FAILURE, DROP_MSG, MSG_DROP_PROB);
 
+	// optional settings, "NAME: value" per line in any order
+	NUM_SEEDS = 1;
+	GRACEFUL_LEAVE = 0;
+	char name[64];
+	char value[64];
+	while ( fscanf(fp, " %63[^:]: %63s", name, value) == 2 ) {
+		if ( 0 == strcmp(name, "NUM_SEEDS") ) {
+			NUM_SEEDS = atoi(value);
+		}
+		else if ( 0 == strcmp(name, "GRACEFUL_LEAVE") ) {
+			GRACEFUL_LEAVE = atoi(value);
+		}
+	}
+
 	EN_GPSZ = MAX_NNB;
 	STEP_RATE=.25;
 	MAX_MSG_SIZE = 4000;
@@ -35,6 +49,7 @@ void Params::setparams(char *config_file) {
 	for ( unsigned int i = 0; i < EN_GPSZ; i++ ) {
 		allNodesJoined += i;
 	}
+	NUM_SEEDS = max(1, min(NUM_SEEDS, EN_GPSZ));
 	fclose(fp);
 	return;
 }
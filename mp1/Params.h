@@ -31,6 +31,8 @@ public:
 	int globaltime;
 	int allNodesJoined;
 	short PORTNUM;
+	int NUM_SEEDS;				// number of introducers, the nodes with ids 1..NUM_SEEDS
+	int GRACEFUL_LEAVE;			// failed nodes announce their leave instead of crashing
 	Params();
 	void setparams(char *);
 	int getcurrtime();
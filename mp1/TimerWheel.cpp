@@ -0,0 +1,131 @@
+/**********************************
+ * FILE NAME: TimerWheel.cpp
+ *
+ * DESCRIPTION: Definition of TimerWheel class functions
+ **********************************/
+
+#include "TimerWheel.h"
+
+/**
+ * Constructor
+ * The slot count is rounded up to a power of two so that the slot of a deadline is a mask away
+ */
+TimerWheel::TimerWheel(size_t slotCount) : currentTick(0) {
+    size_t size = 1;
+    while (size < slotCount) {
+        size <<= 1;
+    }
+    slots.resize(size);
+    mask = size - 1;
+}
+
+/**
+ * FUNCTION NAME: reset
+ *
+ * DESCRIPTION: Drop all the timers and restart the wheel at the given tick
+ */
+void TimerWheel::reset(long tick) {
+    for (auto &slot: slots) {
+        slot.clear();
+    }
+    timers.clear();
+    currentTick = tick;
+}
+
+/**
+ * FUNCTION NAME: schedule
+ *
+ * DESCRIPTION: Arm the timer of key so it fires at deadline. A pending timer of the same key is replaced.
+ * 				Deadlines that have already passed fire on the next advance.
+ */
+void TimerWheel::schedule(uint64_t key, long deadline) {
+    cancel(key);
+
+    long tick = max(deadline, currentTick + 1);
+    size_t slot = static_cast<size_t>(tick) & mask;
+    slots[slot].push_back(Timer{key, deadline});
+    timers[key] = make_pair(slot, slots[slot].size() - 1);
+}
+
+/**
+ * FUNCTION NAME: cancel
+ *
+ * DESCRIPTION: Disarm the timer of key
+ *
+ * RETURNS:
+ * true if a timer was pending
+ */
+bool TimerWheel::cancel(uint64_t key) {
+    auto it = timers.find(key);
+    if (it == timers.end()) {
+        return false;
+    }
+
+    removeAt(it->second.first, it->second.second);
+    return true;
+}
+
+/**
+ * FUNCTION NAME: isScheduled
+ *
+ * DESCRIPTION: Check if key has a pending timer
+ */
+bool TimerWheel::isScheduled(uint64_t key) const {
+    return timers.count(key) != 0;
+}
+
+/**
+ * FUNCTION NAME: size
+ *
+ * DESCRIPTION: Number of pending timers
+ */
+size_t TimerWheel::size() const {
+    return timers.size();
+}
+
+/**
+ * FUNCTION NAME: advance
+ *
+ * DESCRIPTION: Move the wheel up to now and append the keys of all the timers that are due to expired.
+ * 				Fired timers are disarmed. Timers hashed into a visited slot but due in a later
+ * 				revolution of the wheel stay armed.
+ */
+void TimerWheel::advance(long now, vector<uint64_t> &expired) {
+    if (now <= currentTick) {
+        return;
+    }
+
+    // every slot is visited at most once, however long the wheel has been idle
+    long last = min(now, currentTick + static_cast<long>(slots.size()));
+    for (long tick = currentTick + 1; tick <= last; ++tick) {
+        size_t slot = static_cast<size_t>(tick) & mask;
+        size_t i = 0;
+        while (i < slots[slot].size()) {
+            const Timer &timer = slots[slot][i];
+            if (timer.deadline <= now) {
+                expired.push_back(timer.key);
+                removeAt(slot, i);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    currentTick = now;
+}
+
+/**
+ * FUNCTION NAME: removeAt
+ *
+ * DESCRIPTION: Swap-remove the timer at the given position and fix up the index of the moved one
+ */
+void TimerWheel::removeAt(size_t slot, size_t position) {
+    vector<Timer> &timersInSlot = slots[slot];
+    timers.erase(timersInSlot[position].key);
+
+    if (position != timersInSlot.size() - 1) {
+        timersInSlot[position] = timersInSlot.back();
+        timers[timersInSlot[position].key].second = position;
+    }
+    timersInSlot.pop_back();
+}
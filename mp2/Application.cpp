@@ -50,6 +50,7 @@ Application::Application(char *infile) {
 	srand (time(NULL));
 	par->setparams(infile);
 	log = new Log(par);
+	metrics = new Metrics(par, log);
 	en = new EmulNet(par);
 	en1 = new EmulNet(par);
 	mp1 = (MP1Node **) malloc(par->EN_GPSZ * sizeof(MP1Node *));
@@ -65,7 +66,7 @@ Application::Application(char *infile) {
 		Address joinaddr;
 		joinaddr = getjoinaddr();
 		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
-		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
+		mp1[i] = new MP1Node(memberNode, par, en, log, metrics, addressOfMemberNode);
 		mp2[i] = new MP2Node(memberNode, par, en1, log, addressOfMemberNode);
 		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
 		log->LOG(&(mp2[i]->getMemberNode()->addr), "APP MP2");
@@ -77,6 +78,7 @@ Application::Application(char *infile) {
  * Destructor
  */
 Application::~Application() {
+	delete metrics;
 	delete log;
 	delete en;
 	delete en1;
@@ -120,6 +122,17 @@ int Application::run()
 		//fail();
 	}
 
+	// Export the membership metrics of the run
+	metrics->report();
+	// and the latencies of the key value store, per coordinator and cluster wide
+	for( i = 0; i <= par->EN_GPSZ-1; i++ ) {
+		mp2[i]->reportOperationStats();
+	}
+	MP2Node::reportClusterOperationStats(mp2, par->EN_GPSZ, log);
+	if ( par->PLACEMENT_REPORT ) {
+		PlacementStrategy::compare(par, log);
+	}
+
 	// Clean up
 	en->ENcleanup();
 	en1->ENcleanup();
@@ -161,6 +174,7 @@ void Application::mp1Run() {
 		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
 			// introduce the ith node into the system at time STEPRATE*i
 			mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
+			metrics->nodeStarted(&mp1[i]->getMemberNode()->addr);
 			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
 			nodeCount += i;
 		}
@@ -267,7 +281,7 @@ void Application::mp2Run() {
 		 * Wait for STABILIZE_TIME after TEST 2 (stabilization protocol should ensure at least
 		 * 3 replicas for all keys at all times)
 		 *
-		 * TEST 3 part 1: Fail two replicas of a key. Read the key and check for READ FAIL message in the log.
+		 * TEST 3 part 1: Fail all but quorum - 1 replicas of a key. Read the key and check for READ FAIL message in the log.
 		 * 				  READ should fail because quorum replicas of the key are not up
 		 *
 		 * Wait for another STABILIZE_TIME after TEST 3 part 1 (stabilization protocol should ensure at least
@@ -302,7 +316,7 @@ void Application::mp2Run() {
 		 * Wait for STABILIZE_TIME after TEST 2 (stabilization protocol should ensure at least
 		 * 3 replicas for all keys at all times)
 		 *
-		 * TEST 3 part 1: Fail two replicas of a key. Update the key and check for READ FAIL message in the log
+		 * TEST 3 part 1: Fail all but quorum - 1 replicas of a key. Update the key and check for READ FAIL message in the log
 		 * 				  UPDATE should fail because quorum replicas of the key are not up
 		 *
 		 * Wait for another STABILIZE_TIME after TEST 3 part 1 (stabilization protocol should ensure at least
@@ -346,6 +360,10 @@ void Application::fail() {
 		#ifdef DEBUGLOG
 		log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 		#endif
+		metrics->nodeFailed(&mp1[removed]->getMemberNode()->addr);
+		if( par->GRACEFUL_LEAVE ) {
+			mp1[removed]->leaveGroup();
+		}
 		mp1[removed]->getMemberNode()->bFailed = true;
 	}
 	else if( par->getcurrtime() == 100 ) {
@@ -354,6 +372,10 @@ void Application::fail() {
 			#ifdef DEBUGLOG
 			log->LOG(&mp1[i]->getMemberNode()->addr, "Node failed at time = %d", par->getcurrtime());
 			#endif
+			metrics->nodeFailed(&mp1[i]->getMemberNode()->addr);
+			if( par->GRACEFUL_LEAVE ) {
+				mp1[i]->leaveGroup();
+			}
 			mp1[i]->getMemberNode()->bFailed = true;
 		}
 	}
@@ -367,7 +389,7 @@ void Application::fail() {
 /**
  * FUNCTION NAME: getjoinaddr
  *
- * DESCRIPTION: This function returns the address of the coordinator
+ * DESCRIPTION: This function returns the address of the group booter, the first of the NUM_SEEDS seeds
  */
 Address Application::getjoinaddr(void){
 	//trace.funcEntry("Application::getjoinaddr");
@@ -379,6 +401,23 @@ Address Application::getjoinaddr(void){
     return joinaddr;
 }
 
+/**
+ * FUNCTION NAME: failNode
+ *
+ * DESCRIPTION: Fails the ith node. With GRACEFUL_LEAVE the node hands its keys off
+ * 				and announces its leave first, otherwise it just crashes.
+ */
+void Application::failNode(int i) {
+	log->LOG(&mp2[i]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
+	metrics->nodeFailed(&mp2[i]->getMemberNode()->addr);
+	if ( par->GRACEFUL_LEAVE ) {
+		mp2[i]->handOff();
+		mp1[i]->leaveGroup();
+	}
+	mp2[i]->getMemberNode()->bFailed = true;
+	mp1[i]->getMemberNode()->bFailed = true;
+}
+
 /**
  * FUNCTION NAME: findARandomNodeThatIsAlive
  *
@@ -392,6 +431,20 @@ int Application::findARandomNodeThatIsAlive() {
 	return number;
 }
 
+/**
+ * FUNCTION NAME: isReplica
+ *
+ * DESCRTPTION: Checks if the node with the given address is one of the replicas
+ */
+bool Application::isReplica(Address *addr, vector<Node *> &replicas) {
+	for ( size_t i = 0; i < replicas.size(); i++ ) {
+		if ( addr->getAddress() == replicas.at(i)->getAddress()->getAddress() ) {
+			return true;
+		}
+	}
+	return false;
+}
+
 /**
  * FUNCTION NAME: initTestKVPairs
  *
@@ -427,14 +480,16 @@ void Application::insertTestKVPairs() {
 	 */
 	initTestKVPairs();
 
-	for ( map<string, string>::iterator it = testKVPairs.begin(); it != testKVPairs.end(); ++it ) {
-		// Step 1. Find a node that is alive
-		number = findARandomNodeThatIsAlive();
+	// Step 1. Find a node that is alive
+	number = findARandomNodeThatIsAlive();
 
-		// Step 2. Issue a create operation
+	// Step 2. Issue the create operations as one batch, one message per replica
+	vector<pair<string, string>> pairs;
+	for ( map<string, string>::iterator it = testKVPairs.begin(); it != testKVPairs.end(); ++it ) {
 		log->LOG(&mp2[number]->getMemberNode()->addr, "CREATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
-		mp2[number]->clientCreate(it->first, it->second);
+		pairs.push_back(*it);
 	}
+	mp2[number]->multiPut(pairs);
 
 	cout<<endl<<"Sent " <<testKVPairs.size() <<" create messages to the ring"<<endl;
 }
@@ -486,8 +541,8 @@ void Application::readTest() {
 	// This key is used for all read tests
 	map<string, string>::iterator it = testKVPairs.begin();
 	int number;
-	vector<Node> replicas;
-	int replicaIdToFail = TERTIARY;
+	vector<Node *> replicas;
+	int replicaIdToFail;
 	int nodeToFail;
 	bool failedOneNode = false;
 
@@ -517,22 +572,23 @@ void Application::readTest() {
 		replicas.clear();
 		replicas = mp2[number]->findNodes(it->first);
 		// if less than quorum replicas are found then exit
-		if ( replicas.size() < (RF-1) ) {
+		if ( replicas.size() < (size_t) par->READ_QUORUM ) {
 			cout<<endl<<"Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: "<<replicas.size()<<endl;
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
 			exit(1);
 		}
 
-		// Step 2.c Fail a replica
+		// Step 2.c Fail a replica, starting from the last one
+		replicaIdToFail = replicas.size() - 1;
 		for ( int i = 0; i < par->EN_GPSZ; i++ ) {
-			if ( mp2[i]->getMemberNode()->addr.getAddress() == replicas.at(replicaIdToFail).getAddress()->getAddress() ) {
+			if ( mp2[i]->getMemberNode()->addr.getAddress() == replicas.at(replicaIdToFail)->getAddress()->getAddress() ) {
 				if ( !mp2[i]->getMemberNode()->bFailed ) {
 					nodeToFail = i;
 					failedOneNode = true;
 					break;
 				}
 				else {
-					// Since we fail at most two nodes, one of the replicas must be alive
+					// Since we fail at most one node here, one of the replicas must be alive
 					if ( replicaIdToFail > 0 ) {
 						replicaIdToFail--;
 					}
@@ -543,9 +599,7 @@ void Application::readTest() {
 			}
 		}
 		if ( failedOneNode ) {
-			log->LOG(&mp2[nodeToFail]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-			mp2[nodeToFail]->getMemberNode()->bFailed = true;
-			mp1[nodeToFail]->getMemberNode()->bFailed = true;
+			failNode(nodeToFail);
 			cout<<endl<<"Failed a replica node"<<endl;
 		}
 		else {
@@ -568,13 +622,15 @@ void Application::readTest() {
 	/** end of test 2 **/
 
 	/**
-	 * Test 3 part 1: Fail two replicas. Test if value is read correctly in quorum number of nodes after TWO OF THE REPLICAS ARE FAILED
+	 * Test 3 part 1: Fail all but quorum - 1 replicas. Test if value is read correctly in quorum number of nodes after TOO MANY REPLICAS FOR A QUORUM ARE FAILED
 	 */
-	// Wait for STABILIZE_TIME and fail two replicas
+	// Wait for STABILIZE_TIME and fail all but quorum - 1 replicas
 	if ( par->getcurrtime() >= (TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME) ) {
 		vector<int> nodesToFail;
 		nodesToFail.clear();
 		int count = 0;
+		// failing this many replicas leaves one fewer than the quorum alive
+		int replicasToFail = par->REPLICATION_FACTOR - par->READ_QUORUM + 1;
 
 		if ( par->getcurrtime() == (TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME) ) {
 			// Step 3.a. Find a node that is alive
@@ -584,14 +640,14 @@ void Application::readTest() {
 			replicas.clear();
 			replicas = mp2[number]->findNodes(it->first);
 
-			// Step 3.b. Fail two replicas
+			// Step 3.b. Fail enough replicas to lose the quorum
 			//cout<<"REPLICAS SIZE: "<<replicas.size();
-			if ( replicas.size() > 2 ) {
-				replicaIdToFail = TERTIARY;
-				while ( count != 2 ) {
+			if ( replicas.size() >= (size_t) replicasToFail ) {
+				replicaIdToFail = replicas.size() - 1;
+				while ( count != replicasToFail ) {
 					int i = 0;
 					while ( i != par->EN_GPSZ ) {
-						if ( mp2[i]->getMemberNode()->addr.getAddress() == replicas.at(replicaIdToFail).getAddress()->getAddress() ) {
+						if ( mp2[i]->getMemberNode()->addr.getAddress() == replicas.at(replicaIdToFail)->getAddress()->getAddress() ) {
 							if ( !mp2[i]->getMemberNode()->bFailed ) {
 								nodesToFail.emplace_back(i);
 								replicaIdToFail--;
@@ -599,7 +655,7 @@ void Application::readTest() {
 								break;
 							}
 							else {
-								// Since we fail at most two nodes, one of the replicas must be alive
+								// Since we leave quorum - 1 replicas, one of them must be alive
 								if ( replicaIdToFail > 0 ) {
 									replicaIdToFail--;
 								}
@@ -611,23 +667,21 @@ void Application::readTest() {
 			}
 			else {
 				// If the code reaches here. Test your stabilization protocol
-				cout<<endl<<"Not enough replicas to fail two nodes. Number of replicas of this key: " <<replicas.size() <<". Exiting test case !! "<<endl;
+				cout<<endl<<"Not enough replicas to fail the quorum. Number of replicas of this key: " <<replicas.size() <<". Exiting test case !! "<<endl;
 				exit(1);
 			}
-			if ( count == 2 ) {
+			if ( count == replicasToFail ) {
 				for ( int i = 0; i < nodesToFail.size(); i++ ) {
 					// Fail a node
-					log->LOG(&mp2[nodesToFail.at(i)]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-					mp2[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
-					mp1[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
+					failNode(nodesToFail.at(i));
 					cout<<endl<<"Failed a replica node"<<endl;
 				}
 			}
 			else {
 				// The code can never reach here
-				log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail two nodes");
+				log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail the quorum");
 				//cout<<"COUNT: " <<count;
-				cout<<"Could not fail two nodes. Exiting!!!";
+				cout<<"Could not fail the quorum. Exiting!!!";
 				exit(1);
 			}
 
@@ -641,7 +695,7 @@ void Application::readTest() {
 		}
 
 		/**
-		 * TEST 3 part 2: After failing two replicas and waiting for STABILIZE_TIME, issue a read
+		 * TEST 3 part 2: After failing the quorum and waiting for STABILIZE_TIME, issue a read
 		 */
 		// Step 3.d Wait for stabilization protocol to kick in
 		if ( par->getcurrtime() == (TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME + STABILIZE_TIME) ) {
@@ -668,13 +722,9 @@ void Application::readTest() {
 		replicas = mp2[number]->findNodes(it->first);
 		for ( int i = 0; i < par->EN_GPSZ; i++ ) {
 			if ( !mp2[i]->getMemberNode()->bFailed ) {
-				if ( mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(PRIMARY).getAddress()->getAddress() &&
-					 mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(SECONDARY).getAddress()->getAddress() &&
-					 mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(TERTIARY).getAddress()->getAddress() ) {
+				if ( !isReplica(&mp2[i]->getMemberNode()->addr, replicas) ) {
 					// Step 4.c Fail a non-replica node
-					log->LOG(&mp2[i]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-					mp2[i]->getMemberNode()->bFailed = true;
-					mp1[i]->getMemberNode()->bFailed = true;
+					failNode(i);
 					failedOneNode = true;
 					cout<<endl<<"Failed a non-replica node"<<endl;
 					break;
@@ -731,8 +781,8 @@ void Application::updateTest() {
 	it++;
 	string newValue = "newValue";
 	int number;
-	vector<Node> replicas;
-	int replicaIdToFail = TERTIARY;
+	vector<Node *> replicas;
+	int replicaIdToFail;
 	int nodeToFail;
 	bool failedOneNode = false;
 
@@ -762,22 +812,23 @@ void Application::updateTest() {
 		replicas.clear();
 		replicas = mp2[number]->findNodes(it->first);
 		// if quorum replicas are not found then exit
-		if ( replicas.size() < RF-1 ) {
+		if ( replicas.size() < (size_t) par->WRITE_QUORUM ) {
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
 			cout<<endl<<"Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: "<<replicas.size()<<endl;
 			exit(1);
 		}
 
-		// Step 2.c Fail a replica
+		// Step 2.c Fail a replica, starting from the last one
+		replicaIdToFail = replicas.size() - 1;
 		for ( int i = 0; i < par->EN_GPSZ; i++ ) {
-			if ( mp2[i]->getMemberNode()->addr.getAddress() == replicas.at(replicaIdToFail).getAddress()->getAddress() ) {
+			if ( mp2[i]->getMemberNode()->addr.getAddress() == replicas.at(replicaIdToFail)->getAddress()->getAddress() ) {
 				if ( !mp2[i]->getMemberNode()->bFailed ) {
 					nodeToFail = i;
 					failedOneNode = true;
 					break;
 				}
 				else {
-					// Since we fail at most two nodes, one of the replicas must be alive
+					// Since we leave quorum - 1 replicas, one of them must be alive
 					if ( replicaIdToFail > 0 ) {
 						replicaIdToFail--;
 					}
@@ -788,9 +839,7 @@ void Application::updateTest() {
 			}
 		}
 		if ( failedOneNode ) {
-			log->LOG(&mp2[nodeToFail]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-			mp2[nodeToFail]->getMemberNode()->bFailed = true;
-			mp1[nodeToFail]->getMemberNode()->bFailed = true;
+			failNode(nodeToFail);
 			cout<<endl<<"Failed a replica node"<<endl;
 		}
 		else {
@@ -813,13 +862,15 @@ void Application::updateTest() {
 	/** end of test 2 **/
 
 	/**
-	 * Test 3 part 1: Fail two replicas. Test if value is updated correctly in quorum number of nodes after TWO OF THE REPLICAS ARE FAILED
+	 * Test 3 part 1: Fail all but quorum - 1 replicas. Test if value is updated correctly in quorum number of nodes after TOO MANY REPLICAS FOR A QUORUM ARE FAILED
 	 */
 	if ( par->getcurrtime() >= (TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME) ) {
 
 		vector<int> nodesToFail;
 		nodesToFail.clear();
 		int count = 0;
+		// failing this many replicas leaves one fewer than the quorum alive
+		int replicasToFail = par->REPLICATION_FACTOR - par->WRITE_QUORUM + 1;
 
 		if ( par->getcurrtime() == (TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME) ) {
 			// Step 3.a. Find a node that is alive
@@ -829,13 +880,13 @@ void Application::updateTest() {
 			replicas.clear();
 			replicas = mp2[number]->findNodes(it->first);
 
-			// Step 3.b. Fail two replicas
-			if ( replicas.size() > 2 ) {
-				replicaIdToFail = TERTIARY;
-				while ( count != 2 ) {
+			// Step 3.b. Fail enough replicas to lose the quorum
+			if ( replicas.size() >= (size_t) replicasToFail ) {
+				replicaIdToFail = replicas.size() - 1;
+				while ( count != replicasToFail ) {
 					int i = 0;
 					while ( i != par->EN_GPSZ ) {
-						if ( mp2[i]->getMemberNode()->addr.getAddress() == replicas.at(replicaIdToFail).getAddress()->getAddress() ) {
+						if ( mp2[i]->getMemberNode()->addr.getAddress() == replicas.at(replicaIdToFail)->getAddress()->getAddress() ) {
 							if ( !mp2[i]->getMemberNode()->bFailed ) {
 								nodesToFail.emplace_back(i);
 								replicaIdToFail--;
@@ -843,7 +894,7 @@ void Application::updateTest() {
 								break;
 							}
 							else {
-								// Since we fail at most two nodes, one of the replicas must be alive
+								// Since we leave quorum - 1 replicas, one of them must be alive
 								if ( replicaIdToFail > 0 ) {
 									replicaIdToFail--;
 								}
@@ -855,21 +906,19 @@ void Application::updateTest() {
 			}
 			else {
 				// If the code reaches here. Test your stabilization protocol
-				cout<<endl<<"Not enough replicas to fail two nodes. Exiting test case !! "<<endl;
+				cout<<endl<<"Not enough replicas to fail the quorum. Exiting test case !! "<<endl;
 			}
-			if ( count == 2 ) {
+			if ( count == replicasToFail ) {
 				for ( int i = 0; i < nodesToFail.size(); i++ ) {
 					// Fail a node
-					log->LOG(&mp2[nodesToFail.at(i)]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-					mp2[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
-					mp1[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
+					failNode(nodesToFail.at(i));
 					cout<<endl<<"Failed a replica node"<<endl;
 				}
 			}
 			else {
 				// The code can never reach here
-				log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail two nodes");
-				cout<<"Could not fail two nodes. Exiting!!!";
+				log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail the quorum");
+				cout<<"Could not fail the quorum. Exiting!!!";
 				exit(1);
 			}
 
@@ -883,7 +932,7 @@ void Application::updateTest() {
 		}
 
 		/**
-		 * TEST 3 part 2: After failing two replicas and waiting for STABILIZE_TIME, issue an update
+		 * TEST 3 part 2: After failing the quorum and waiting for STABILIZE_TIME, issue an update
 		 */
 		// Step 3.d Wait for stabilization protocol to kick in
 		if ( par->getcurrtime() == (TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME + STABILIZE_TIME) ) {
@@ -910,13 +959,9 @@ void Application::updateTest() {
 		replicas = mp2[number]->findNodes(it->first);
 		for ( int i = 0; i < par->EN_GPSZ; i++ ) {
 			if ( !mp2[i]->getMemberNode()->bFailed ) {
-				if ( mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(PRIMARY).getAddress()->getAddress() &&
-					 mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(SECONDARY).getAddress()->getAddress() &&
-					 mp2[i]->getMemberNode()->addr.getAddress() != replicas.at(TERTIARY).getAddress()->getAddress() ) {
+				if ( !isReplica(&mp2[i]->getMemberNode()->addr, replicas) ) {
 					// Step 4.c Fail a non-replica node
-					log->LOG(&mp2[i]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
-					mp2[i]->getMemberNode()->bFailed = true;
-					mp1[i]->getMemberNode()->bFailed = true;
+					failNode(i);
 					failedOneNode = true;
 					cout<<endl<<"Failed a non-replica node"<<endl;
 					break;
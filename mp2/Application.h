@@ -14,6 +14,7 @@
 #include "Member.h"
 #include "EmulNet.h"
 #include "Queue.h"
+#include "Metrics.h"
 #include "MP2Node.h"
 #include "Node.h"
 #include "common.h"
@@ -37,7 +38,6 @@ static const char alphanum[] =
 #define STABILIZE_TIME 50
 #define FIRST_FAIL_TIME 25
 #define LAST_FAIL_TIME 10
-#define RF 3
 #define NUMBER_OF_INSERTS 100
 #define KEY_LENGTH 5
 
@@ -54,6 +54,7 @@ private:
 	EmulNet *en;
 	EmulNet *en1;
     Log *log;
+	Metrics *metrics;
 	MP1Node **mp1;
 	MP2Node **mp2;
 	Params *par;
@@ -67,8 +68,10 @@ public:
 	void mp1Run();
 	void mp2Run();
 	void fail();
+	void failNode(int i);
 	void insertTestKVPairs();
 	int findARandomNodeThatIsAlive();
+	bool isReplica(Address *addr, vector<Node *> &replicas);
 	void deleteTest();
 	void readTest();
 	void updateTest();
@@ -0,0 +1,113 @@
+/**********************************
+ * FILE NAME: Histogram.cpp
+ *
+ * DESCRIPTION: Definition of Histogram class functions
+ **********************************/
+
+#include "Histogram.h"
+
+/**
+ * Constructor
+ */
+Histogram::Histogram() : total(0), sum(0), maxValue(0) {}
+
+/**
+ * FUNCTION NAME: indexOf
+ *
+ * DESCRIPTION: Bucket of a value. The top HISTOGRAM_SUB_BUCKET_BITS + 1 bits of the value pick the
+ * 				bucket within its power of two range, the bits below them are dropped.
+ */
+size_t Histogram::indexOf(long value) {
+    const long subBuckets = 1L << HISTOGRAM_SUB_BUCKET_BITS;
+    int shift = 0;
+    while ((value >> shift) >= 2 * subBuckets) {
+        ++shift;
+    }
+    if (shift == 0) {
+        return static_cast<size_t>(value);
+    }
+    return static_cast<size_t>((shift + 1) * subBuckets + (value >> shift) - subBuckets);
+}
+
+/**
+ * FUNCTION NAME: highestEquivalent
+ *
+ * DESCRIPTION: Largest value that falls into the bucket
+ */
+long Histogram::highestEquivalent(size_t index) {
+    const long subBuckets = 1L << HISTOGRAM_SUB_BUCKET_BITS;
+    long i = static_cast<long>(index);
+    if (i < 2 * subBuckets) {
+        return i;
+    }
+    long shift = i / subBuckets - 1;
+    long lowest = (i % subBuckets + subBuckets) << shift;
+    return lowest + (1L << shift) - 1;
+}
+
+/**
+ * FUNCTION NAME: record
+ *
+ * DESCRIPTION: Counts a value, negative values count as 0
+ */
+void Histogram::record(long value) {
+    value = std::max(0L, value);
+    size_t index = indexOf(value);
+    if (index >= counts.size()) {
+        counts.resize(index + 1, 0);
+    }
+    counts[index]++;
+    total++;
+    sum += value;
+    maxValue = std::max(maxValue, value);
+}
+
+/**
+ * FUNCTION NAME: merge
+ *
+ * DESCRIPTION: Adds the values of the other histogram to this one
+ */
+void Histogram::merge(const Histogram &other) {
+    if (other.counts.size() > counts.size()) {
+        counts.resize(other.counts.size(), 0);
+    }
+    for (size_t i = 0; i < other.counts.size(); ++i) {
+        counts[i] += other.counts[i];
+    }
+    total += other.total;
+    sum += other.sum;
+    maxValue = std::max(maxValue, other.maxValue);
+}
+
+/**
+ * FUNCTION NAME: mean
+ *
+ * DESCRIPTION: Exact mean of the recorded values, 0 without any
+ */
+double Histogram::mean() const {
+    return total == 0 ? 0 : static_cast<double>(sum) / total;
+}
+
+/**
+ * FUNCTION NAME: percentile
+ *
+ * DESCRIPTION: Walks the buckets up to the one holding the value of the given rank
+ *
+ * RETURNS:
+ * The largest value of that bucket, but never more than the largest value recorded. 0 without any
+ */
+long Histogram::percentile(double percent) const {
+    if (total == 0) {
+        return 0;
+    }
+
+    long rank = std::max(1L, static_cast<long>(ceil(percent / 100 * total)));
+    long seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(highestEquivalent(i), maxValue);
+        }
+    }
+    return maxValue;
+}
@@ -0,0 +1,60 @@
+/**********************************
+ * FILE NAME: Histogram.h
+ *
+ * DESCRIPTION: Header file of Histogram class
+ **********************************/
+
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+#include "stdincludes.h"
+
+/**
+ * Macros
+ */
+// every power of two range of values is split into 2^HISTOGRAM_SUB_BUCKET_BITS buckets,
+// so a recorded value is off by less than 1 / 2^HISTOGRAM_SUB_BUCKET_BITS of itself
+#define HISTOGRAM_SUB_BUCKET_BITS 4
+
+/**
+ * CLASS NAME: Histogram
+ *
+ * DESCRIPTION: HDR style histogram of non-negative values. Values below 2^(HISTOGRAM_SUB_BUCKET_BITS + 1)
+ * 				have a bucket each, larger ones share logarithmically spaced buckets with a fixed
+ * 				relative precision. Recording is O(1), the buckets grow with the largest value, and
+ * 				histograms merge by adding their buckets, which is how per node histograms add up
+ * 				to cluster wide ones.
+ */
+class Histogram {
+private:
+    vector<long> counts;
+    long total;
+    long sum;
+    long maxValue;
+
+    static size_t indexOf(long value);
+
+    static long highestEquivalent(size_t index);
+
+public:
+    Histogram();
+
+    void record(long value);
+
+    void merge(const Histogram &other);
+
+    long count() const {
+        return total;
+    }
+
+    long max() const {
+        return maxValue;
+    }
+
+    double mean() const;
+
+    // the value percent of the recorded values are at or below, within the precision of the buckets
+    long percentile(double percent) const;
+};
+
+#endif /* HISTOGRAM_H_ */
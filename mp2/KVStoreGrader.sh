@@ -22,17 +22,41 @@ function contains () {
     echo 0
 }
 
+function conf_file () {
+	if [ -n "${SCENARIO}" ]
+	then
+		echo "./testcases/$1_${SCENARIO}.conf"
+	else
+		echo "./testcases/$1.conf"
+	fi
+}
+
+function conf_value () {
+	local value=`grep "^$2:" "$1" 2>/dev/null | cut -d" " -f2`
+	echo "${value:-$3}"
+}
+
 ####
 # Main function
 ####
 
 verbose=$(contains "-v" "$@")
+# without a scenario the default test cases are graded, with one the <test>_<scenario>.conf test cases
+SCENARIO=""
+for arg in "$@"
+do
+	if [ "${arg}" != "-v" ]
+	then
+		SCENARIO="${arg}"
+	fi
+done
 
 ###
 # Global variables
 ###
 SUCCESS=0
 FAILURE=-1
+# replication factor and quorum, read from the test case of every test
 RF=3
 RFPLUSONE=4
 CREATE_OPERATION="CREATE OPERATION"
@@ -60,6 +84,10 @@ echo ""
 CREATE_TEST_STATUS="${SUCCESS}"
 CREATE_TEST_SCORE=0
 
+CREATE_CONF=$(conf_file create)
+RF=$(conf_value ${CREATE_CONF} REPLICATION_FACTOR 3)
+RFPLUSONE=$(( ${RF} + 1 ))
+
 if [ "${verbose}" -eq 0 ]
 then
     make clean > /dev/null 2>&1
@@ -69,7 +97,7 @@ then
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-    ./Application ./testcases/create.conf > /dev/null 2>&1
+    ./Application ${CREATE_CONF} > /dev/null 2>&1
 else
 	make clean
 	make
@@ -78,10 +106,10 @@ else
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-	./Application ./testcases/create.conf
+	./Application ${CREATE_CONF}
 fi
 
-echo "TEST 1: Create 3 replicas of every key"
+echo "TEST 1: Create ${RF} replicas of every key"
 
 create_count=`grep -i "${CREATE_OPERATION}" dbg.log | wc -l`
 create_success_count=`grep -i "${CREATE_SUCCESS}" dbg.log | wc -l`
@@ -130,6 +158,10 @@ DELETE_TEST2_STATUS="${SUCCESS}"
 DELETE_TEST1_SCORE=0
 DELETE_TEST2_SCORE=0
 
+DELETE_CONF=$(conf_file delete)
+RF=$(conf_value ${DELETE_CONF} REPLICATION_FACTOR 3)
+RFPLUSONE=$(( ${RF} + 1 ))
+
 if [ "${verbose}" -eq 0 ]
 then
     make clean > /dev/null 2>&1
@@ -139,7 +171,7 @@ then
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-    ./Application ./testcases/delete.conf > /dev/null 2>&1
+    ./Application ${DELETE_CONF} > /dev/null 2>&1
 else
 	make clean
 	make
@@ -148,10 +180,10 @@ else
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-	./Application ./testcases/delete.conf
+	./Application ${DELETE_CONF}
 fi
 
-echo "TEST 1: Delete 3 replicas of every key"
+echo "TEST 1: Delete ${RF} replicas of every key"
 
 delete_count=`grep -i "${DELETE_OPERATION}" dbg.log | wc -l`
 valid_delete_count=$(( ${delete_count} - 1 ))
@@ -181,7 +213,7 @@ fi
 echo "TEST 2: Attempt delete of an invalid key"
 
 delete_fail_count=`grep -i "${DELETE_FAILURE}" dbg.log | grep "${INVALID_KEY}" | wc -l`
-if [ "${delete_fail_count}" -ne 4 ]
+if [ "${delete_fail_count}" -ne "${RFPLUSONE}" ]
 then
 	DELETE_TEST2_STATUS="${FAILURE}"
 fi
@@ -228,6 +260,12 @@ READ_TEST4_SCORE=0
 READ_TEST5_STATUS="${FAILURE}"
 READ_TEST5_SCORE=0
 
+READ_CONF=$(conf_file read)
+RF=$(conf_value ${READ_CONF} REPLICATION_FACTOR 3)
+RFPLUSONE=$(( ${RF} + 1 ))
+QUORUM=$(conf_value ${READ_CONF} READ_QUORUM 2)
+QUORUMPLUSONE=$(( ${QUORUM} + 1 ))
+
 if [ "${verbose}" -eq 0 ]
 then
     make clean > /dev/null 2>&1
@@ -237,7 +275,7 @@ then
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-    ./Application ./testcases/read.conf > /dev/null 2>&1
+    ./Application ${READ_CONF} > /dev/null 2>&1
 else
 	make clean
 	make
@@ -246,7 +284,7 @@ else
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-	./Application ./testcases/read.conf
+	./Application ${READ_CONF}
 fi
 
 read_operations=`grep -i "${READ_OPERATION}" dbg.log  | cut -d" " -f3 | tr -s ']' ' '  | tr -s '[' ' ' | sort`
@@ -346,11 +384,11 @@ then
 	done <<<"${read_fails}"
 fi
 
-if [ "${read_test1_success_count}" -eq "${QUORUMPLUSONE}" -o "${read_test1_success_count}" -eq "${RFPLUSONE}" ]
+if [ "${read_test1_success_count}" -ge "${QUORUMPLUSONE}" -a "${read_test1_success_count}" -le "${RFPLUSONE}" ]
 then
 	READ_TEST1_STATUS="${SUCCESS}"
 fi
-if [ "${read_test2_success_count}" -eq "${QUORUMPLUSONE}" ]
+if [ "${read_test2_success_count}" -ge "${QUORUMPLUSONE}" -a "${read_test2_success_count}" -le "${RF}" ]
 then
 	READ_TEST2_STATUS="${SUCCESS}"
 fi
@@ -358,15 +396,15 @@ if [ "${read_test3_part1_fail_count}" -eq 1 ]
 then
 	READ_TEST3_PART1_STATUS="${SUCCESS}"
 fi
-if [ "${read_test3_part2_success_count}" -eq "${QUORUMPLUSONE}" -o "${read_test3_part2_success_count}" -eq "${RFPLUSONE}" ]
+if [ "${read_test3_part2_success_count}" -ge "${QUORUMPLUSONE}" -a "${read_test3_part2_success_count}" -le "${RFPLUSONE}" ]
 then
 	READ_TEST3_PART2_STATUS="${SUCCESS}"
 fi
-if [ "${read_test4_success_count}" -eq "${QUORUMPLUSONE}" -o "${read_test4_success_count}" -eq "${RFPLUSONE}" ]
+if [ "${read_test4_success_count}" -ge "${QUORUMPLUSONE}" -a "${read_test4_success_count}" -le "${RFPLUSONE}" ]
 then
 	READ_TEST4_STATUS="${SUCCESS}"
 fi
-if [ "${read_test5_fail_count}" -eq "${QUORUMPLUSONE}" -o "${read_test5_fail_count}" -eq "${RFPLUSONE}" ]
+if [ "${read_test5_fail_count}" -ge "${QUORUMPLUSONE}" -a "${read_test5_fail_count}" -le "${RFPLUSONE}" ]
 then
 	READ_TEST5_STATUS="${SUCCESS}"
 fi
@@ -436,6 +474,12 @@ UPDATE_TEST4_SCORE=0
 UPDATE_TEST5_STATUS="${FAILURE}"
 UPDATE_TEST5_SCORE=0
 
+UPDATE_CONF=$(conf_file update)
+RF=$(conf_value ${UPDATE_CONF} REPLICATION_FACTOR 3)
+RFPLUSONE=$(( ${RF} + 1 ))
+QUORUM=$(conf_value ${UPDATE_CONF} WRITE_QUORUM 2)
+QUORUMPLUSONE=$(( ${QUORUM} + 1 ))
+
 if [ "${verbose}" -eq 0 ]
 then
     make clean > /dev/null 2>&1
@@ -445,7 +489,7 @@ then
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-    ./Application ./testcases/update.conf > /dev/null 2>&1
+    ./Application ${UPDATE_CONF} > /dev/null 2>&1
 else
 	make clean
 	make
@@ -454,7 +498,7 @@ else
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-	./Application ./testcases/update.conf
+	./Application ${UPDATE_CONF}
 fi
 
 update_operations=`grep -i "${UPDATE_OPERATION}" dbg.log  | cut -d" " -f3 | tr -s ']' ' '  | tr -s '[' ' ' | sort`
@@ -554,11 +598,11 @@ then
 	done <<<"${update_fails}"
 fi
 
-if [ "${update_test1_success_count}" -eq "${QUORUMPLUSONE}" -o "${update_test1_success_count}" -eq "${RFPLUSONE}" ]
+if [ "${update_test1_success_count}" -ge "${QUORUMPLUSONE}" -a "${update_test1_success_count}" -le "${RFPLUSONE}" ]
 then
 	UPDATE_TEST1_STATUS="${SUCCESS}"
 fi
-if [ "${update_test2_success_count}" -eq "${QUORUMPLUSONE}" ]
+if [ "${update_test2_success_count}" -ge "${QUORUMPLUSONE}" -a "${update_test2_success_count}" -le "${RF}" ]
 then
 	UPDATE_TEST2_STATUS="${SUCCESS}"
 fi
@@ -566,15 +610,15 @@ if [ "${update_test3_part1_fail_count}" -eq 1 ]
 then
 	UPDATE_TEST3_PART1_STATUS="${SUCCESS}"
 fi
-if [ "${update_test3_part2_success_count}" -eq "${QUORUMPLUSONE}" -o "${update_test3_part2_success_count}" -eq "${RFPLUSONE}" ]
+if [ "${update_test3_part2_success_count}" -ge "${QUORUMPLUSONE}" -a "${update_test3_part2_success_count}" -le "${RFPLUSONE}" ]
 then
 	UPDATE_TEST3_PART2_STATUS="${SUCCESS}"
 fi
-if [ "${update_test4_success_count}" -eq "${QUORUMPLUSONE}" -o "${update_test4_success_count}" -eq "${RFPLUSONE}" ]
+if [ "${update_test4_success_count}" -ge "${QUORUMPLUSONE}" -a "${update_test4_success_count}" -le "${RFPLUSONE}" ]
 then
 	UPDATE_TEST4_STATUS="${SUCCESS}"
 fi
-if [ "${update_test5_fail_count}" -eq "${QUORUMPLUSONE}" -o "${update_test5_fail_count}" -eq "${RFPLUSONE}" ]
+if [ "${update_test5_fail_count}" -ge "${QUORUMPLUSONE}" -a "${update_test5_fail_count}" -le "${RFPLUSONE}" ]
 then
 	UPDATE_TEST5_STATUS="${SUCCESS}"
 fi
@@ -625,6 +669,30 @@ GRADE=`echo ${GRADE} ${UPDATE_TEST5_SCORE} | awk '{print $1 + $2}'`
 #echo "############################"
 #echo ""
 
+# the placement report is written to the stats log at the end of the run, one line per strategy
+if [ "$(conf_value ${UPDATE_CONF} PLACEMENT_REPORT 0)" -ne 0 ]
+then
+	placement_reports=`grep "#STATSLOG# placement" stats.log | wc -l`
+	if [ "${placement_reports}" -eq 3 ]
+	then
+		echo "PLACEMENT REPORT..................: present"
+	else
+		echo "PLACEMENT REPORT..................: missing"
+	fi
+fi
+
 echo ""
 echo "TOTAL GRADE: ${GRADE} / 90" 
 echo ""
+
+# grade every scenario that has test cases of its own
+if [ -z "${SCENARIO}" ]
+then
+	for conf in `ls ./testcases/create_*.conf 2>/dev/null`
+	do
+		scenario=`basename ${conf} .conf | cut -d"_" -f2-`
+		scenario_grade=`bash $0 ${scenario} | grep "TOTAL GRADE" | cut -d" " -f3-`
+		echo "SCENARIO ${scenario} GRADE: ${scenario_grade}"
+	done
+	echo ""
+fi
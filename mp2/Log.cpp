@@ -135,14 +135,14 @@ void Log::logNodeRemove(Address *thisNode, Address *removedAddr) {
  *
  * DESCRTION: Call this function after successfully create a key value pair
  */
-void Log::logCreateSuccess(Address * address, bool isCoordinator, int transID, string key, string value){
-	static char stdstring[100];
+void Log::logCreateSuccess(Address * address, bool isCoordinator, uint64_t transID, string key, string value){
+	static char stdstring[512];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
 	else
 		str = "server";
-	sprintf(stdstring, "%s: create success at time %d, transID=%d, key=%s, value=%s", str.c_str(), par->getcurrtime(), transID, key.c_str(), value.c_str());
+	snprintf(stdstring, sizeof(stdstring), "%s: create success at time %d, transID=%llu, key=%s, value=%s", str.c_str(), par->getcurrtime(), (unsigned long long) transID, key.c_str(), value.c_str());
     LOG(address, stdstring);
 }
 
@@ -151,14 +151,14 @@ void Log::logCreateSuccess(Address * address, bool isCoordinator, int transID, s
  *
  * DESCRIPTION: Call this function after successfully reading a key
  */
-void Log::logReadSuccess(Address * address, bool isCoordinator, int transID, string key, string value){
-    static char stdstring[100];
+void Log::logReadSuccess(Address * address, bool isCoordinator, uint64_t transID, string key, string value){
+    static char stdstring[512];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
 	else
 		str = "server";
-	sprintf(stdstring, "%s: read success at time %d, transID=%d, key=%s, value=%s", str.c_str(), par->getcurrtime(), transID, key.c_str(), value.c_str());
+	snprintf(stdstring, sizeof(stdstring), "%s: read success at time %d, transID=%llu, key=%s, value=%s", str.c_str(), par->getcurrtime(), (unsigned long long) transID, key.c_str(), value.c_str());
     LOG(address, stdstring);
 }
 
@@ -167,14 +167,14 @@ void Log::logReadSuccess(Address * address, bool isCoordinator, int transID, str
  *
  * DESCRIPTION: Call this function after successfully updating a key
  */
-void Log::logUpdateSuccess(Address * address, bool isCoordinator, int transID, string key, string newValue){
-    static char stdstring[100];
+void Log::logUpdateSuccess(Address * address, bool isCoordinator, uint64_t transID, string key, string newValue){
+    static char stdstring[512];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
 	else
 		str = "server";
-	sprintf(stdstring, "%s: update success at time %d, transID=%d, key=%s, value=%s", str.c_str(), par->getcurrtime(), transID, key.c_str(), newValue.c_str());
+	snprintf(stdstring, sizeof(stdstring), "%s: update success at time %d, transID=%llu, key=%s, value=%s", str.c_str(), par->getcurrtime(), (unsigned long long) transID, key.c_str(), newValue.c_str());
     LOG(address, stdstring);
 }
 
@@ -183,14 +183,14 @@ void Log::logUpdateSuccess(Address * address, bool isCoordinator, int transID, s
  *
  * DESCRIPTION: Call this function after successfully deleting a key
  */
-void Log::logDeleteSuccess(Address * address, bool isCoordinator, int transID, string key){
-    static char stdstring[100];
+void Log::logDeleteSuccess(Address * address, bool isCoordinator, uint64_t transID, string key){
+    static char stdstring[512];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
 	else
 		str = "server";
-	sprintf(stdstring, "%s: delete success at time %d, transID=%d, key=%s", str.c_str(), par->getcurrtime(), transID, key.c_str());
+	snprintf(stdstring, sizeof(stdstring), "%s: delete success at time %d, transID=%llu, key=%s", str.c_str(), par->getcurrtime(), (unsigned long long) transID, key.c_str());
     LOG(address, stdstring);
 }
 
@@ -199,14 +199,14 @@ void Log::logDeleteSuccess(Address * address, bool isCoordinator, int transID, s
  *
  * DESCRIPTION: Call this function if CREATE failed
  */
-void Log::logCreateFail(Address * address, bool isCoordinator, int transID, string key, string value){
-	static char stdstring[100];
+void Log::logCreateFail(Address * address, bool isCoordinator, uint64_t transID, string key, string value){
+	static char stdstring[512];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
 	else
 		str = "server";
-	sprintf(stdstring, "%s: create fail at time %d, transID=%d, key=%s, value=%s", str.c_str(), par->getcurrtime(), transID, key.c_str(), value.c_str());
+	snprintf(stdstring, sizeof(stdstring), "%s: create fail at time %d, transID=%llu, key=%s, value=%s", str.c_str(), par->getcurrtime(), (unsigned long long) transID, key.c_str(), value.c_str());
     LOG(address, stdstring);
 }
 
@@ -216,14 +216,14 @@ void Log::logCreateFail(Address * address, bool isCoordinator, int transID, stri
  *
  * DESCRIPTION: Call this function if READ failed
  */
-void Log::logReadFail(Address * address, bool isCoordinator, int transID, string key){
-    static char stdstring[100];
+void Log::logReadFail(Address * address, bool isCoordinator, uint64_t transID, string key){
+    static char stdstring[512];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
 	else
 		str = "server";
-	sprintf(stdstring, "%s: read fail at time %d, transID=%d, key=%s", str.c_str(), par->getcurrtime(), transID, key.c_str());
+	snprintf(stdstring, sizeof(stdstring), "%s: read fail at time %d, transID=%llu, key=%s", str.c_str(), par->getcurrtime(), (unsigned long long) transID, key.c_str());
     LOG(address, stdstring);
 }
 
@@ -232,14 +232,14 @@ void Log::logReadFail(Address * address, bool isCoordinator, int transID, string
  *
  * DESCRIPTION: Call this function if UPDATE failed
  */
-void Log::logUpdateFail(Address * address, bool isCoordinator, int transID, string key, string newValue){
-    static char stdstring[100];
+void Log::logUpdateFail(Address * address, bool isCoordinator, uint64_t transID, string key, string newValue){
+    static char stdstring[512];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
 	else
 		str = "server";
-	sprintf(stdstring, "%s: update fail at time %d, transID=%d, key=%s, value=%s", str.c_str(), par->getcurrtime(), transID, key.c_str(), newValue.c_str());
+	snprintf(stdstring, sizeof(stdstring), "%s: update fail at time %d, transID=%llu, key=%s, value=%s", str.c_str(), par->getcurrtime(), (unsigned long long) transID, key.c_str(), newValue.c_str());
     LOG(address, stdstring);
 }
 
@@ -248,13 +248,13 @@ void Log::logUpdateFail(Address * address, bool isCoordinator, int transID, stri
  *
  * DESCRIPTION: Call this function if DELETE failed
  */
-void Log::logDeleteFail(Address * address, bool isCoordinator, int transID, string key){
-    static char stdstring[100];
+void Log::logDeleteFail(Address * address, bool isCoordinator, uint64_t transID, string key){
+    static char stdstring[512];
 	string str;
 	if (isCoordinator)
 		str = "coordinator";
 	else
 		str = "server";
-	sprintf(stdstring, "%s: delete fail at time %d, transID=%d, key=%s", str.c_str(), par->getcurrtime(), transID, key.c_str());
+	snprintf(stdstring, sizeof(stdstring), "%s: delete fail at time %d, transID=%llu, key=%s", str.c_str(), par->getcurrtime(), (unsigned long long) transID, key.c_str());
     LOG(address, stdstring);
 }
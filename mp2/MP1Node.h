@@ -14,8 +14,12 @@
 #include "Member.h"
 #include "EmulNet.h"
 #include "Queue.h"
+#include "TimerWheel.h"
+#include "Metrics.h"
 
 #include <memory>
+#include <random>
+#include <unordered_map>
 
 using std::shared_ptr;
 
@@ -24,6 +28,9 @@ using std::shared_ptr;
  */
 #define TREMOVE 20
 #define TFAIL 5
+#define EXPIRY_WHEEL_SLOTS 32
+// ticks to wait for a JOINREP before asking the next seed
+#define JOIN_TIMEOUT 5
 
 /*
  * Note: You can change/add any functions in MP1Node.{h,cpp}
@@ -35,7 +42,8 @@ using std::shared_ptr;
 enum MsgTypes {
     JOINREQ,
     JOINREP,
-    HEARTBEAT
+    HEARTBEAT,
+    LEAVE
 };
 
 /**
@@ -47,6 +55,25 @@ typedef struct MessageHdr {
     enum MsgTypes msgType;
 } MessageHdr;
 
+/**
+ * STRUCT NAME: MemberListColumns
+ *
+ * DESCRIPTION: Membership list carried by JOINREP, HEARTBEAT and LEAVE messages.
+ * 				The entries are sent in id order, column by column, starting at MEMBER_LIST_OFFSET:
+ * 				{size_t count; long heartbeats[count]; long timestamps[count]; int ids[count]; short ports[count]}
+ * 				so every column is naturally aligned. The pointers refer into the received message.
+ */
+struct MemberListColumns {
+    size_t count;
+    const long *heartbeats;
+    const long *timestamps;
+    const int *ids;
+    const short *ports;
+};
+
+// the member list starts at the first long boundary after the header
+#define MEMBER_LIST_OFFSET ((sizeof(MessageHdr) + sizeof(long) - 1) / sizeof(long) * sizeof(long))
+
 /**
  * CLASS NAME: MP1Node
  *
@@ -57,11 +84,38 @@ private:
     EmulNet *emulNet;
     Log *log;
     Params *par;
+    Metrics *metrics;
     Member *memberNode;
     char NULLADDR[6];
+    // TFAIL/TREMOVE deadlines of the member list entries, keyed by member id
+    TimerWheel expiryWheel;
+    // buffer for the ids handed out by expiryWheel
+    vector<uint64_t> expiredMembers;
+    // my own member id
+    int selfId;
+    // ids of the members heard from within TFAIL, i.e. the heartbeat receivers.
+    // gossip shuffles it in place to sample the receivers of a round
+    vector<int> freshMembers;
+    // member id -> position in freshMembers
+    unordered_map<int, size_t> freshIndex;
+    // number of JOINREQs sent so far, picks the seed to ask next
+    int joinAttempts;
+    // time the last JOINREQ was sent
+    int joinRequestTime;
+    // members that announced a LEAVE -> heartbeat they left with, kept for TREMOVE
+    // so that stale gossip does not bring them back
+    unordered_map<int, long> leftMembers;
+    // random source of this node
+    std::mt19937 rng;
+    // outgoing HEARTBEAT and LEAVE messages, reused across rounds
+    vector<char> gossipBuffer;
+    // scratch buffers of the membership table scans and merges, reused across rounds
+    vector<size_t> selectedMembers;
+    vector<size_t> updatedMembers;
+    vector<size_t> unknownMembers;
 
 public:
-    MP1Node(Member *, Params *, EmulNet *, Log *, Address *);
+    MP1Node(Member *, Params *, EmulNet *, Log *, Metrics *, Address *);
 
     Member *getMemberNode() {
         return memberNode;
@@ -77,6 +131,8 @@ public:
 
     int introduceSelfToGroup(Address *joinAddress);
 
+    void leaveGroup();
+
     int finishUpThisNode();
 
     void nodeLoop();
@@ -87,12 +143,44 @@ public:
 
     void nodeLoopOps();
 
+    void mergeMemberList(const MemberListColumns &incoming);
+
+    void gossip(MessageHdr *msg, int size);
+
+    void sendMessage(Address *toaddr, char *msg, int size);
+
+    void handleLeave(const MemberListEntry &entry);
+
+    void gossipLeave(const MemberListEntry &entry, bool toAll);
+
+    bool hasLeft(const MemberListEntry &entry);
+
     int isNullAddress(Address *addr);
 
     Address getJoinAddress();
 
+    Address getSeedAddress(int seed);
+
     void initMemberListTable(Member *memberNode);
 
+    size_t findMember(int id);
+
+    void addMember(const MemberListEntry &entry);
+
+    void removeMember(int id);
+
+    void scheduleExpiry(int id, long timestamp);
+
+    void expireMembers();
+
+    void markFresh(int id);
+
+    void markSuspected(int id);
+
+    void publishEvent(MembershipEventType type, const MemberListEntry &entry);
+
+    void swapFresh(size_t i, size_t j);
+
     void printAddress(Address *addr);
 
     virtual ~MP1Node();
@@ -5,100 +5,114 @@
  **********************************/
 #include "MP2Node.h"
 
-using std::hash;
-
 /**
  * constructor
  */
-MP2Node::MP2Node(Member *memberNode, Params *par, EmulNet *emulNet, Log *log, Address *address) {
+MP2Node::MP2Node(Member *memberNode, Params *par, EmulNet *emulNet, Log *log, Address *address)
+        : transIDs(*reinterpret_cast<int *>(address->addr)),
+          deadlines(TRANSACTION_WHEEL_SLOTS), hedges(TRANSACTION_WHEEL_SLOTS) {
     this->memberNode = memberNode;
     this->par = par;
     this->emulNet = emulNet;
     this->log = log;
     ht = new HashTable();
     this->memberNode->addr = *address;
-    this->ring = vector<Node>();
-    this->transactionMap = unordered_map<int, Message>();
+    this->placement = PlacementStrategy::create(par->PLACEMENT, par);
+    this->ringChanged = false;
+    this->ringEpoch = 0;
+    this->replyLatencies.assign(TRANSACTION_TIMEOUT + 1, 0);
+    this->replyLatencySamples = 0;
+    this->merkleDirty = true;
+    this->nextAntiEntropy = 0;
 }
 
 /**
  * Destructor
  */
 MP2Node::~MP2Node() {
+    delete placement;
     delete ht;
     delete memberNode;
 }
 
-bool ringsAreEqual(vector<Node> &fst, vector<Node> &snd) {
-    if (fst.size() != snd.size()) return false;
-
-    for (int i = 0; i < fst.size(); ++i) {
-        if (!(*(fst[i].getAddress()) == *(snd[i].getAddress()))) return false;
-    }
-
-    return true;
-}
-
 /**
  * FUNCTION NAME: updateRing
  *
  * DESCRIPTION: This function does the following:
- * 				1) Gets the current membership list from the Membership Protocol (MP1Node)
- * 				   The membership list is returned as a vector of Nodes. See Node class in Node.h
- * 				2) Constructs the ring based on the membership list
- * 				3) Calls the Stabilization Protocol
+ * 				1) Drains the membership changes published by the Membership Protocol (MP1Node)
+ * 				   since the last call. See MembershipEvent in Member.h. The transaction ids
+ * 				   of this node start a new epoch at the time it started
+ * 				2) Applies them to the placement one by one, see Placement.h
+ * 				3) Rebuilds the placement and calls the Stabilization Protocol if the ring has changed
+ * 				Without membership changes a call costs nothing more than the checks.
  */
 void MP2Node::updateRing() {
     /*
-     * Implement this. Parts of it are already implemented
+     * Step 1 and 2: Apply the membership changes to the ring
      */
-    vector<Node> curMemList;
-    bool change;
-
-    /*
-     *  Step 1. Get the current membership list from Membership Protocol / MP1
-     */
-    curMemList = getMembershipList();
-
-    /*
-     * Step 2: Construct the ring
-     */
-    // Sort the list based on the hashCode
-    sort(curMemList.begin(), curMemList.end());
-    change = !ringsAreEqual(this->ring, curMemList);
+    while (!memberNode->membershipEvents.empty()) {
+        MembershipEvent &event = memberNode->membershipEvents.front();
+        if (event.type == MEMBER_JOINED) {
+            // this node (re)started, the ids of the previous run must not be handed out again
+            if (event.addr == memberNode->addr) {
+                transIDs.restart(event.time);
+            }
+            addToRing(event.addr);
+        } else {
+            removeFromRing(event.addr);
+        }
+        ringEpoch = event.epoch;
+        memberNode->membershipEvents.pop();
+    }
 
     /*
      * Step 3: Run the stabilization protocol IF REQUIRED
      */
-    // Run stabilization protocol if the hash table size is greater than zero and if there has been a changed in the ring
-    if (change) {
+    if (ringChanged) {
+        ringChanged = false;
+        placement->rebuild();
+        findNeighbors();
         stabilizationProtocol();
-        this->ring = curMemList;
     }
 }
 
 /**
- * FUNCTION NAME: getMemberhipList
+ * FUNCTION NAME: addToRing
+ *
+ * DESCRIPTION: Adds the node to the placement, with all of its VIRTUAL_NODES tokens on the ring
  *
- * DESCRIPTION: This function goes through the membership list from the Membership protocol/MP1 and
- * 				i) generates the hash code for each member
- * 				ii) populates the ring member in MP2Node class
- * 				It returns a vector of Nodes. Each element in the vector contain the following fields:
- * 				a) Address of the node
- * 				b) Hash code obtained by consistent hashing of the Address
+ * RETURNS:
+ * true if the ring has changed
  */
-vector<Node> MP2Node::getMembershipList() {
-    unsigned int i;
-    vector<Node> curMemList;
-    for (i = 0; i < this->memberNode->memberList.size(); i++) {
-        Address addressOfThisMember;
-        int id = this->memberNode->memberList.at(i).getid();
-        short port = this->memberNode->memberList.at(i).getport();
-        memcpy(&addressOfThisMember.addr[0], &id, sizeof(int));
-        memcpy(&addressOfThisMember.addr[4], &port, sizeof(short));
-        curMemList.emplace_back(Node(addressOfThisMember));
-    }
-    return curMemList;
+bool MP2Node::addToRing(const Address &address) {
+    bool added = placement->addNode(address);
+    ringChanged |= added;
+    return added;
+}
+
+/**
+ * FUNCTION NAME: removeFromRing
+ *
+ * DESCRIPTION: Removes the node from the placement
+ *
+ * RETURNS:
+ * true if the ring has changed
+ */
+bool MP2Node::removeFromRing(const Address &address) {
+    bool removed = placement->removeNode(address);
+    ringChanged |= removed;
+    return removed;
+}
+
+/**
+ * FUNCTION NAME: findNeighbors
+ *
+ * DESCRIPTION: Asks the placement for the replication neighbours of this node
+ */
+void MP2Node::findNeighbors() {
+    hasMyReplicas.clear();
+    haveReplicasOf.clear();
+    placement->findNeighbors(memberNode->addr, hasMyReplicas, haveReplicasOf);
 }
 
 /**
@@ -108,25 +122,15 @@ vector<Node> MP2Node::getMembershipList() {
  * 				HASH FUNCTION USED FOR CONSISTENT HASHING
  *
  * RETURNS:
- * size_t position on the ring
+ * uint64_t position on the ring
  */
-size_t MP2Node::hashFunction(string key) {
-    std::hash<string> hashFunc;
-    size_t ret = hashFunc(key);
-    return ret % RING_SIZE;
+uint64_t MP2Node::hashFunction(const string &key) {
+    return hashBytes(key.data(), key.size());
 }
 
 
 ReplicaType getReplicaType(int index) {
-    if (index == 0) {
-        return PRIMARY;
-    }
-
-    if (index == 1) {
-        return SECONDARY;
-    }
-
-    return TERTIARY;
+    return static_cast<ReplicaType>(index);
 }
 
 /**
@@ -136,18 +140,22 @@ ReplicaType getReplicaType(int index) {
  * 				The function does the following:
  * 				1) Constructs the message
  * 				2) Finds the replicas of this key
- * 				3) Sends a message to the replica
+ * 				3) Sends a message to the replica, or to the node standing in for it, see findWriteTargets
+ * 				4) Waits for WRITE_QUORUM replies, see startTransaction
+ *
+ * RETURNS:
+ * The handle of the operation, its completion carries the same transID
  */
-void MP2Node::clientCreate(string key, string value) {
-    auto vector = this->findNodes(key);
-    for (int i = 0; i < vector.size(); ++i) {
-        ReplicaType replicaType = getReplicaType(i);
-
-        Message message(g_transID++, this->memberNode->addr, CREATE, key, value, replicaType);
-        int transId = g_transID;
-        this->emulNet->ENsend(&this->memberNode->addr, vector[i].getAddress(), message.toString());
-        this->transactionMap.insert(std::pair<int, Message>(std::move(transId), std::move(message)));
+uint64_t MP2Node::clientCreate(string key, string value, CompletionCallback done) {
+    findWriteTargets(key);
+    uint64_t transID = transIDs.next();
+    for (size_t i = 0; i < writeTargets.size(); ++i) {
+        Message message(transID, this->memberNode->addr, CREATE, key, value, getReplicaType(i));
+        message.hint = writeHints[i];
+        this->emulNet->ENsend(&this->memberNode->addr, writeTargets[i]->getAddress(), message.toString());
     }
+    startTransaction(transID, CREATE, key, value, writeTargets.size(), done);
+    return transID;
 }
 
 /**
@@ -157,12 +165,35 @@ void MP2Node::clientCreate(string key, string value) {
  * 				The function does the following:
  * 				1) Constructs the message
  * 				2) Finds the replicas of this key
- * 				3) Sends a message to the replica
+ * 				3) Sends the message to the first READ_QUORUM replicas, all of them have to answer.
+ * 				   The others are asked one by one if they are late or fail, see sendBackup
+ *
+ * RETURNS:
+ * The handle of the operation, its completion carries the same transID
  */
-void MP2Node::clientRead(string key) {
-    auto vector = this->findNodes(key);
-    Message message(g_transID++, this->memberNode->addr, READ, key);
-    this->emulNet->ENsend(&this->memberNode->addr, vector[0].getAddress(), message.toString());
+uint64_t MP2Node::clientRead(string key, CompletionCallback done) {
+    auto &vector = this->findNodes(key);
+    uint64_t transID = transIDs.next();
+    Message message(transID, this->memberNode->addr, READ, key);
+    size_t asked = min(vector.size(), static_cast<size_t>(par->READ_QUORUM));
+    for (size_t i = 0; i < asked; ++i) {
+        this->emulNet->ENsend(&this->memberNode->addr, vector[i]->getAddress(), message.toString());
+    }
+    deque<Address> backups;
+    for (size_t i = asked; i < vector.size(); ++i) {
+        backups.push_back(*vector[i]->getAddress());
+    }
+
+    startTransaction(transID, READ, key, "", vector.size(), done);
+    auto it = transactions.find(transID);
+    if (it != transactions.end()) {
+        it->second.asked = asked;
+        it->second.backups = std::move(backups);
+        if (!it->second.backups.empty()) {
+            hedges.schedule(transID, par->getcurrtime() + hedgeDelay());
+        }
+    }
+    return transID;
 }
 
 /**
@@ -172,16 +203,22 @@ void MP2Node::clientRead(string key) {
  * 				The function does the following:
  * 				1) Constructs the message
  * 				2) Finds the replicas of this key
- * 				3) Sends a message to the replica
+ * 				3) Sends a message to the replica, or to the node standing in for it, see findWriteTargets
+ * 				4) Waits for WRITE_QUORUM replies, see startTransaction
+ *
+ * RETURNS:
+ * The handle of the operation, its completion carries the same transID
  */
-void MP2Node::clientUpdate(string key, string value) {
-    auto vector = this->findNodes(key);
-    for (int i = 0; i < vector.size(); ++i) {
-        ReplicaType replicaType = getReplicaType(i);
-
-        Message message(g_transID++, this->memberNode->addr, UPDATE, key, value, replicaType);
-        this->emulNet->ENsend(&this->memberNode->addr, vector[i].getAddress(), message.toString());
+uint64_t MP2Node::clientUpdate(string key, string value, CompletionCallback done) {
+    findWriteTargets(key);
+    uint64_t transID = transIDs.next();
+    for (size_t i = 0; i < writeTargets.size(); ++i) {
+        Message message(transID, this->memberNode->addr, UPDATE, key, value, getReplicaType(i));
+        message.hint = writeHints[i];
+        this->emulNet->ENsend(&this->memberNode->addr, writeTargets[i]->getAddress(), message.toString());
     }
+    startTransaction(transID, UPDATE, key, value, writeTargets.size(), done);
+    return transID;
 }
 
 /**
@@ -192,12 +229,519 @@ void MP2Node::clientUpdate(string key, string value) {
  * 				1) Constructs the message
  * 				2) Finds the replicas of this key
  * 				3) Sends a message to the replica
+ * 				4) Waits for WRITE_QUORUM replies, see startTransaction
+ *
+ * RETURNS:
+ * The handle of the operation, its completion carries the same transID
+ */
+uint64_t MP2Node::clientDelete(string key, CompletionCallback done) {
+    auto &vector = this->findNodes(key);
+    uint64_t transID = transIDs.next();
+    Message message(transID, this->memberNode->addr, DELETE, key);
+    for (auto replica: vector) {
+        this->emulNet->ENsend(&this->memberNode->addr, replica->getAddress(), message.toString());
+    }
+    startTransaction(transID, DELETE, key, "", vector.size(), done);
+    return transID;
+}
+
+/**
+ * FUNCTION NAME: multiPut
+ *
+ * DESCRIPTION: client side batched CREATE API
+ * 				Every key is a transaction of its own, as if created with clientCreate, but the keys
+ * 				are grouped by replica so that every replica gets one MULTIPUT message for all of
+ * 				its keys instead of one message per key
+ *
+ * RETURNS:
+ * The transID of every key, in the order of the pairs
+ */
+vector<uint64_t> MP2Node::multiPut(const vector<pair<string, string>> &pairs, CompletionCallback done) {
+    vector<uint64_t> handles;
+    for (auto &pair: pairs) {
+        findWriteTargets(pair.first);
+        uint64_t transID = transIDs.next();
+        for (size_t i = 0; i < writeTargets.size(); ++i) {
+            addToBatch(writeTargets[i]->getAddress(), MULTIPUT,
+                       BatchEntry{transID, pair.first, pair.second, getReplicaType(i), false, writeHints[i]});
+        }
+        startTransaction(transID, CREATE, pair.first, pair.second, writeTargets.size(), done);
+        handles.push_back(transID);
+    }
+    flushBatches();
+    return handles;
+}
+
+/**
+ * FUNCTION NAME: multiGet
+ *
+ * DESCRIPTION: client side batched READ API
+ * 				The batched counterpart of clientRead, every replica gets one MULTIGET message
+ *
+ * RETURNS:
+ * The transID of every key, in the order of the keys
  */
-void MP2Node::clientDelete(string key) {
-    auto vector = this->findNodes(key);
-    for (auto &i : vector) {
-        Message message(g_transID++, this->memberNode->addr, DELETE, key);
-        this->emulNet->ENsend(&this->memberNode->addr, i.getAddress(), message.toString());
+vector<uint64_t> MP2Node::multiGet(const vector<string> &keys, CompletionCallback done) {
+    vector<uint64_t> handles;
+    for (auto &key: keys) {
+        auto &vector = this->findNodes(key);
+        uint64_t transID = transIDs.next();
+        for (auto replica: vector) {
+            addToBatch(replica->getAddress(), MULTIGET, BatchEntry{transID, key, "", PRIMARY, false});
+        }
+        startTransaction(transID, READ, key, "", vector.size(), done);
+        handles.push_back(transID);
+    }
+    flushBatches();
+    return handles;
+}
+
+/**
+ * FUNCTION NAME: isSuspected
+ *
+ * DESCRIPTION: Whether the membership protocol has not heard from the node within TFAIL,
+ * 				or does not know it at all
+ */
+bool MP2Node::isSuspected(Address *address) {
+    int id = 0;
+    memcpy(&id, &address->addr[0], sizeof(int));
+    MembershipTable &members = memberNode->memberList;
+    size_t position = members.find(id);
+    return position == members.size() || par->getcurrtime() - members.gettimestamp(position) > TFAIL;
+}
+
+/**
+ * FUNCTION NAME: findWriteTargets
+ *
+ * DESCRIPTION: Sloppy quorum. Fills writeTargets with the replicas of the key, except that every
+ * 				replica the membership protocol suspects is replaced by the next healthy node after
+ * 				the replicas, which keeps the write as a hint for it. writeHints[i] is the address of
+ * 				the replica writeTargets[i] stands in for, empty if it is the replica itself.
+ * 				A suspected replica nobody can stand in for is written to anyway.
+ */
+void MP2Node::findWriteTargets(const string &key) {
+    auto &replicas = findNodes(key);
+    writeTargets.assign(replicas.begin(), replicas.end());
+    writeHints.assign(replicas.size(), "");
+
+    bool suspected = false;
+    for (auto replica: replicas) {
+        suspected |= isSuspected(replica->getAddress());
+    }
+    if (!suspected) {
+        return;
+    }
+
+    // the successors start with the replicas, the healthy ones after them stand in
+    placement->findSuccessors(hashFunction(key), placement->nodeCount(), successors);
+    size_t next = writeTargets.size();
+    for (size_t i = 0; i < writeTargets.size(); ++i) {
+        if (!isSuspected(writeTargets[i]->getAddress())) {
+            continue;
+        }
+        while (next < successors.size() && isSuspected(successors[next]->getAddress())) {
+            ++next;
+        }
+        if (next == successors.size()) {
+            break;
+        }
+        writeHints[i] = writeTargets[i]->getAddress()->getAddress();
+        writeTargets[i] = successors[next++];
+    }
+}
+
+/**
+ * FUNCTION NAME: storeHint
+ *
+ * DESCRIPTION: Server side of a hinted write. Keeps the entry for the replica owner until it is
+ * 				healthy again. At most MAX_HINTS hints are kept, the oldest one is dropped for a new one.
+ * 				A hinted UPDATE fails unless this node knows the key, from its own hash table or an
+ * 				earlier hint, as an update of a key that does not exist has to.
+ */
+bool MP2Node::storeHint(MessageType type, const string &owner, const string &key, const string &value,
+                        ReplicaType replica) {
+    if (type == UPDATE && ht->read(key).empty()) {
+        bool known = false;
+        for (auto &hint: hints) {
+            known |= hint.key == key;
+        }
+        if (!known) {
+            return false;
+        }
+    }
+
+    if (hints.size() >= MAX_HINTS) {
+        hints.pop_front();
+    }
+    hints.push_back(Hint{type, Address(owner), key, Entry(value, par->getcurrtime(), replica).convertToString(),
+                         par->getcurrtime(), transIDs.next(), -1});
+    return true;
+}
+
+/**
+ * FUNCTION NAME: replayHints
+ *
+ * DESCRIPTION: Sends every hint whose replica is healthy again to it as a transfer, which the replica
+ * 				only applies if it has nothing newer. The transfer of an UPDATE never creates the key.
+ * 				A hint is kept and sent again every HINT_RETRY ticks until the replica acknowledges it.
+ * 				Hints older than HINT_TTL are dropped, by then the replica has either recovered or been
+ * 				replaced by the stabilization protocol.
+ */
+void MP2Node::replayHints() {
+    int now = par->getcurrtime();
+    size_t kept = 0;
+    for (auto &hint: hints) {
+        if (now - hint.storedAt > HINT_TTL) {
+            continue;
+        }
+        if (!isSuspected(&hint.owner) && (hint.sentAt < 0 || now - hint.sentAt >= HINT_RETRY)) {
+            Message message(hint.transID, memberNode->addr, hint.type == UPDATE ? TRANSFERUPDATE : TRANSFER, hint.key,
+                            hint.entry, Entry(hint.entry).replica);
+            emulNet->ENsend(&memberNode->addr, &hint.owner, message.toString());
+            hint.sentAt = now;
+        }
+        hints[kept++] = hint;
+    }
+    hints.resize(kept);
+}
+
+/**
+ * FUNCTION NAME: ackHint
+ *
+ * DESCRIPTION: Drops the hint the replica has acknowledged the replay of
+ *
+ * RETURNS:
+ * false if no hint was replayed with the transID to that replica
+ */
+bool MP2Node::ackHint(uint64_t transID, Address &from) {
+    for (auto it = hints.begin(); it != hints.end(); ++it) {
+        if (it->transID == transID && it->owner == from) {
+            hints.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * FUNCTION NAME: maxMessageSize
+ *
+ * DESCRIPTION: Longest message string EmulNet accepts
+ */
+size_t MP2Node::maxMessageSize() {
+    return par->MAX_MSG_SIZE - sizeof(en_msg) - 1;
+}
+
+/**
+ * FUNCTION NAME: addToBatch
+ *
+ * DESCRIPTION: Appends the key to the batch message for the receiver. A batch that would outgrow
+ * 				what EmulNet accepts is sent first and a new one is started.
+ */
+void MP2Node::addToBatch(Address *to, MessageType type, const BatchEntry &entry) {
+    size_t limit = maxMessageSize();
+    string receiver = to->getAddress();
+    auto it = batches.find(receiver);
+    if (it == batches.end()) {
+        Message message(entry.transID, memberNode->addr, type, vector<BatchEntry>());
+        size_t header = message.toString().size();
+        it = batches.emplace(receiver, Batch{message, header}).first;
+    }
+
+    Batch &batch = it->second;
+    size_t bytes = batch.message.entryToString(entry).size() + batch.message.delimiter.size();
+    if (!batch.message.batch.empty() && batch.bytes + bytes > limit) {
+        emulNet->ENsend(&memberNode->addr, to, batch.message.toString());
+        batch.message.transID = entry.transID;
+        batch.message.batch.clear();
+        batch.bytes = batch.message.toString().size();
+    }
+    batch.message.batch.push_back(entry);
+    batch.bytes += bytes;
+}
+
+/**
+ * FUNCTION NAME: flushBatches
+ *
+ * DESCRIPTION: Sends the batch messages under construction
+ */
+void MP2Node::flushBatches() {
+    for (auto &pair: batches) {
+        Address to(pair.first);
+        emulNet->ENsend(&memberNode->addr, &to, pair.second.message.toString());
+    }
+    batches.clear();
+}
+
+/**
+ * FUNCTION NAME: startTransaction
+ *
+ * DESCRIPTION: Opens the transaction of a client operation that has been sent to the given number of
+ * 				replicas and arms its deadline. The client gets its answer at the latest
+ * 				TRANSACTION_TIMEOUT ticks later, at once if there are too few replicas to reach quorum.
+ * 				done, if set, gets the Completion of the transaction. Many transactions can be open at the
+ * 				same time, each completes on its own.
+ */
+void MP2Node::startTransaction(uint64_t transID, MessageType type, const string &key, const string &value, int replicas,
+                               const CompletionCallback &done) {
+    Transaction &transaction = transactions[transID];
+    transaction.type = type;
+    transaction.key = key;
+    transaction.value = value;
+    transaction.replicas = replicas;
+    transaction.quorum = type == READ ? par->READ_QUORUM : par->WRITE_QUORUM;
+    transaction.asked = replicas;
+    transaction.backups.clear();
+    transaction.replies = 0;
+    transaction.successes = 0;
+    transaction.decided = false;
+    transaction.succeeded = false;
+    transaction.startTime = par->getcurrtime();
+    transaction.retries = 0;
+    transaction.done = done;
+
+    if (replicas < transaction.quorum) {
+        finishTransaction(transID, false);
+        return;
+    }
+    deadlines.schedule(transID, par->getcurrtime() + TRANSACTION_TIMEOUT);
+}
+
+/**
+ * FUNCTION NAME: handleReply
+ *
+ * DESCRIPTION: Counts a REPLY or READREPLY towards its transaction. The transaction succeeds with
+ * 				quorum successful replies and fails as soon as the replies still outstanding cannot
+ * 				make up the quorum. A decided read still collects the late replies for read repair,
+ * 				replies of other decided or expired transactions are dropped.
+ */
+void MP2Node::handleReply(uint64_t transID, Address &from, bool success, const string &entry) {
+    auto it = transactions.find(transID);
+    if (it == transactions.end()) {
+        return;
+    }
+
+    Transaction &transaction = it->second;
+    transaction.replies++;
+    if (transaction.type != READ || transaction.asked == min(transaction.replicas, par->READ_QUORUM)) {
+        recordReplyLatency(par->getcurrtime() - transaction.startTime);
+    }
+    if (transaction.type == READ) {
+        transaction.versions.emplace_back(from, success ? entry : "");
+    }
+    if (success) {
+        transaction.successes++;
+        if (transaction.type == READ &&
+            (transaction.latest.empty() || Entry(entry).timestamp > Entry(transaction.latest).timestamp)) {
+            transaction.latest = entry;
+        }
+    }
+
+    if (transaction.decided) {
+        if (transaction.replies == transaction.asked) {
+            closeTransaction(it);
+        }
+    } else if (transaction.successes >= transaction.quorum) {
+        finishTransaction(transID, true);
+    } else if (transaction.successes + transaction.replicas - transaction.replies < transaction.quorum) {
+        finishTransaction(transID, false);
+    } else if (!success) {
+        // the failed replica cannot count towards quorum, no use waiting to hedge
+        sendBackup(transID, transaction);
+    }
+}
+
+/**
+ * FUNCTION NAME: sendBackup
+ *
+ * DESCRIPTION: Hedges a read by asking the next replica of the preference list that has not been
+ * 				asked yet. Whichever replies make up the quorum first decide the read.
+ *
+ * RETURNS:
+ * false if every replica has been asked
+ */
+bool MP2Node::sendBackup(uint64_t transID, Transaction &transaction) {
+    if (transaction.backups.empty()) {
+        return false;
+    }
+
+    Message message(transID, memberNode->addr, READ, transaction.key);
+    emulNet->ENsend(&memberNode->addr, &transaction.backups.front(), message.toString());
+    transaction.backups.pop_front();
+    transaction.asked++;
+    transaction.retries++;
+    return true;
+}
+
+/**
+ * FUNCTION NAME: recordReplyLatency
+ *
+ * DESCRIPTION: Adds the latency of a reply to a request sent when its transaction started
+ */
+void MP2Node::recordReplyLatency(int ticks) {
+    replyLatencies[max(0, min(ticks, TRANSACTION_TIMEOUT))]++;
+    if (++replyLatencySamples < LATENCY_WINDOW) {
+        return;
+    }
+
+    // halving keeps the percentile following the current latencies
+    replyLatencySamples = 0;
+    for (auto &count: replyLatencies) {
+        count /= 2;
+        replyLatencySamples += count;
+    }
+}
+
+/**
+ * FUNCTION NAME: hedgeDelay
+ *
+ * DESCRIPTION: Ticks a read waits before it hedges, the HEDGE_PERCENTILE of the reply latencies
+ */
+int MP2Node::hedgeDelay() {
+    if (replyLatencySamples == 0) {
+        return TRANSACTION_TIMEOUT / 2;
+    }
+
+    long rank = (replyLatencySamples * HEDGE_PERCENTILE + 99) / 100;
+    long seen = 0;
+    for (int ticks = 0; ticks < static_cast<int>(replyLatencies.size()); ++ticks) {
+        seen += replyLatencies[ticks];
+        if (seen >= rank) {
+            return max(1, ticks);
+        }
+    }
+    return TRANSACTION_TIMEOUT;
+}
+
+/**
+ * FUNCTION NAME: finishTransaction
+ *
+ * DESCRIPTION: Logs the outcome of the transaction as its coordinator, records its latency, fan-out
+ * 				and retries, forgets it and calls its completion callback
+ */
+void MP2Node::finishTransaction(uint64_t transID, bool success) {
+    auto it = transactions.find(transID);
+    Transaction &transaction = it->second;
+    Address *addr = &memberNode->addr;
+    switch (transaction.type) {
+        case CREATE:
+            if (success) {
+                log->logCreateSuccess(addr, true, transID, transaction.key, transaction.value);
+            } else {
+                log->logCreateFail(addr, true, transID, transaction.key, transaction.value);
+            }
+            break;
+        case READ:
+            if (success) {
+                log->logReadSuccess(addr, true, transID, transaction.key, Entry(transaction.latest).value);
+            } else {
+                log->logReadFail(addr, true, transID, transaction.key);
+            }
+            break;
+        case UPDATE:
+            if (success) {
+                log->logUpdateSuccess(addr, true, transID, transaction.key, transaction.value);
+            } else {
+                log->logUpdateFail(addr, true, transID, transaction.key, transaction.value);
+            }
+            break;
+        case DELETE:
+            if (success) {
+                log->logDeleteSuccess(addr, true, transID, transaction.key);
+            } else {
+                log->logDeleteFail(addr, true, transID, transaction.key);
+            }
+            break;
+        default:
+            break;
+    }
+
+    OperationStats &stats = operationStats[transaction.type];
+    stats.latency.record(par->getcurrtime() - transaction.startTime);
+    stats.fanOut.record(transaction.asked);
+    stats.retries.record(transaction.retries);
+    stats.failures += success ? 0 : 1;
+
+    Completion completion{transID, transaction.type, transaction.key,
+                          transaction.type == READ ? (success ? Entry(transaction.latest).value : "") : transaction.value,
+                          success, transaction.startTime, par->getcurrtime()};
+    CompletionCallback done = std::move(transaction.done);
+
+    transaction.succeeded = success;
+    // a successful read stays open for the replies still outstanding, they may come from stale replicas
+    hedges.cancel(transID);
+    if (transaction.type == READ && success && transaction.replies < transaction.asked) {
+        transaction.decided = true;
+    } else {
+        closeTransaction(it);
+    }
+
+    // the callback may start new operations, so it runs once the transaction is no longer touched
+    if (done) {
+        done(completion);
+    }
+}
+
+/**
+ * FUNCTION NAME: closeTransaction
+ *
+ * DESCRIPTION: Forgets a decided transaction. A successful read first repairs the replicas that
+ * 				answered with an older version of the key, or without it, by sending them the newest
+ * 				entry. Replicas store a transfer only if it is newer than what they have.
+ */
+void MP2Node::closeTransaction(unordered_map<uint64_t, Transaction>::iterator it) {
+    Transaction &transaction = it->second;
+    if (transaction.type == READ && transaction.succeeded && !transaction.latest.empty()) {
+        int newest = Entry(transaction.latest).timestamp;
+        auto &replicas = findNodes(transaction.key);
+        for (auto &version: transaction.versions) {
+            if (!version.second.empty() && Entry(version.second).timestamp >= newest) {
+                continue;
+            }
+            for (size_t i = 0; i < replicas.size(); ++i) {
+                if (*replicas[i]->getAddress() == version.first) {
+                    Message message(0, memberNode->addr, TRANSFER, transaction.key, transaction.latest,
+                                    getReplicaType(i));
+                    emulNet->ENsend(&memberNode->addr, replicas[i]->getAddress(), message.toString());
+                }
+            }
+        }
+    }
+
+    deadlines.cancel(it->first);
+    hedges.cancel(it->first);
+    transactions.erase(it);
+}
+
+/**
+ * FUNCTION NAME: checkTimeouts
+ *
+ * DESCRIPTION: Fails the transactions whose deadline has passed without a decision
+ * 				and hedges the reads that have waited for longer than hedgeDelay()
+ */
+void MP2Node::checkTimeouts() {
+    expiredTransactions.clear();
+    deadlines.advance(par->getcurrtime(), expiredTransactions);
+    for (uint64_t transID: expiredTransactions) {
+        auto it = transactions.find(static_cast<uint64_t>(transID));
+        if (it == transactions.end()) {
+            continue;
+        }
+        if (it->second.decided) {
+            closeTransaction(it);
+        } else {
+            finishTransaction(static_cast<uint64_t>(transID), false);
+        }
+    }
+
+    expiredTransactions.clear();
+    hedges.advance(par->getcurrtime(), expiredTransactions);
+    for (uint64_t transID: expiredTransactions) {
+        auto it = transactions.find(static_cast<uint64_t>(transID));
+        if (it != transactions.end() && !it->second.decided && sendBackup(it->first, it->second) &&
+            !it->second.backups.empty()) {
+            hedges.schedule(transID, par->getcurrtime() + hedgeDelay());
+        }
     }
 }
 
@@ -211,6 +755,8 @@ void MP2Node::clientDelete(string key) {
  */
 bool MP2Node::createKeyValue(string key, string value, ReplicaType replica) {
     // Insert key, value, replicaType into the hash table
+    merkleDirty = true;
+    tombstones.erase(key);
     return ht->create(std::move(key), Entry(std::move(value), this->par->getcurrtime(), replica).convertToString());
 }
 
@@ -220,7 +766,7 @@ bool MP2Node::createKeyValue(string key, string value, ReplicaType replica) {
  * DESCRIPTION: Server side READ API
  * 			    This function does the following:
  * 			    1) Read key from local hash table
- * 			    2) Return value
+ * 			    2) Return the entry of the key, empty if there is none
  */
 string MP2Node::readKey(string key) {
     // Read key from local hash table and return value
@@ -237,6 +783,7 @@ string MP2Node::readKey(string key) {
  */
 bool MP2Node::updateKeyValue(string key, string value, ReplicaType replica) {
     // Update key in local hash table and return true or false
+    merkleDirty = true;
     return ht->update(std::move(key), Entry(std::move(value), par->getcurrtime(), replica).convertToString());
 }
 
@@ -246,13 +793,93 @@ bool MP2Node::updateKeyValue(string key, string value, ReplicaType replica) {
  * DESCRIPTION: Server side DELETE API
  * 				This function does the following:
  * 				1) Delete the key from the local hash table
- * 				2) Return true or false based on success or failure
+ * 				2) Leave a tombstone for it, also if it was not here
+ * 				3) Return true or false based on success or failure
  */
 bool MP2Node::deletekey(string key) {
     // Delete the key from the local hash table
+    merkleDirty = true;
+    tombstones[key] = par->getcurrtime();
     return ht->deleteKey(std::move(key));
 }
 
+/**
+ * FUNCTION NAME: transferKeyValue
+ *
+ * DESCRIPTION: Server side of a replica transfer between nodes.
+ * 				Stores the entry unless a newer version of the key, or a tombstone at least as new, is
+ * 				already here. Without create
+ * 				only a key that is already here is updated. Transfers are not client operations,
+ * 				so nothing is logged.
+ */
+bool MP2Node::transferKeyValue(string key, string entry, ReplicaType replica, bool create) {
+    Entry incoming(entry);
+    incoming.replica = replica;
+    auto tombstone = tombstones.find(key);
+    if (tombstone != tombstones.end() && tombstone->second >= incoming.timestamp) {
+        return false;
+    }
+    merkleDirty = true;
+
+    string current = ht->read(key);
+    if (current.empty()) {
+        if (!create) {
+            return false;
+        }
+        tombstones.erase(key);
+        return ht->create(std::move(key), incoming.convertToString());
+    }
+    if (Entry(current).timestamp <= incoming.timestamp) {
+        tombstones.erase(key);
+        return ht->update(std::move(key), incoming.convertToString());
+    }
+
+    return false;
+}
+
+/**
+ * FUNCTION NAME: handOff
+ *
+ * DESCRIPTION: Called before this node leaves gracefully. Takes this node off the ring and
+ * 				streams every local key to the replicas that only become responsible for it
+ * 				once this node is gone, so the key never drops below its replication factor.
+ */
+void MP2Node::handOff() {
+    // the replicas point into the placement, so the current owners are copied before the ring changes
+    vector<vector<Address>> owners;
+    for (auto &pair: ht->hashTable) {
+        owners.emplace_back();
+        for (auto node: findNodes(pair.first)) {
+            owners.back().push_back(*node->getAddress());
+        }
+    }
+
+    removeFromRing(memberNode->addr);
+    placement->rebuild();
+
+    map<string, vector<BatchEntry>> ranges;
+    size_t k = 0;
+    for (auto &pair: ht->hashTable) {
+        vector<Address> &before = owners[k++];
+        auto &after = findNodes(pair.first);
+        for (size_t i = 0; i < after.size(); ++i) {
+            bool wasReplica = false;
+            for (auto &address: before) {
+                wasReplica |= address == *after[i]->getAddress();
+            }
+            if (!wasReplica) {
+                ranges[after[i]->getAddress()->getAddress()].push_back(
+                        BatchEntry{0, pair.first, pair.second, getReplicaType(i), false});
+            }
+        }
+    }
+
+    // this node is gone before any acknowledgement could arrive
+    for (auto &range: ranges) {
+        startStream(Address(range.first), std::move(range.second), false, false);
+    }
+}
+
 /**
  * FUNCTION NAME: checkMessages
  *
@@ -289,7 +916,8 @@ void MP2Node::checkMessages() {
         Message message(std::move(messageStr));
         if (message.type == CREATE) {
 
-            bool succeed = createKeyValue(message.key, message.value, message.replica);
+            bool succeed = message.hint.empty() ? createKeyValue(message.key, message.value, message.replica)
+                                                : storeHint(CREATE, message.hint, message.key, message.value, message.replica);
             if (succeed) {
                 log->logCreateSuccess(&memberNode->addr, false, message.transID, message.key, message.value);
             } else {
@@ -298,7 +926,8 @@ void MP2Node::checkMessages() {
             Message response = Message(message.transID, memberNode->addr, REPLY, succeed);
             emulNet->ENsend(&memberNode->addr, &message.fromAddr, response.toString());
         } else if (message.type == UPDATE) {
-            bool succeed = updateKeyValue(message.key, message.value, message.replica);
+            bool succeed = message.hint.empty() ? updateKeyValue(message.key, message.value, message.replica)
+                                                : storeHint(UPDATE, message.hint, message.key, message.value, message.replica);
             if (succeed) {
                 log->logUpdateSuccess(&memberNode->addr, false, message.transID, message.key, message.value);
             } else {
@@ -316,45 +945,60 @@ void MP2Node::checkMessages() {
             Message response = Message(message.transID, memberNode->addr, REPLY, succeed);
             emulNet->ENsend(&memberNode->addr, &message.fromAddr, response.toString());
         } else if (message.type == READ) {
-            string value = readKey(message.key);
-            if (!value.empty()) {
-                log->logReadSuccess(&memberNode->addr, false, message.transID, message.key, value);
-
+            string entry = readKey(message.key);
+            if (!entry.empty()) {
+                log->logReadSuccess(&memberNode->addr, false, message.transID, message.key, Entry(entry).value);
             } else {
                 log->logReadFail(&memberNode->addr, false, message.transID, message.key);
             }
-            Message response = Message(message.transID, memberNode->addr, READREPLY, value);
+            Message response = Message(message.transID, memberNode->addr, entry);
             emulNet->ENsend(&memberNode->addr, &message.fromAddr, response.toString());
-        } else if (message.type == READ) {
-            Message &saved_message = (this->transactionMap.find(message.transID))->second;
-            if (message.success) {
-                if (saved_message.type == CREATE) {
-                    log->logCreateSuccess(&memberNode->addr, true, message.transID, saved_message.key,
-                                          saved_message.value);
-                } else if (saved_message.type == DELETE) {
-                    log->logDeleteSuccess(&memberNode->addr, true, message.transID, saved_message.key);
-                } else if (saved_message.type == UPDATE) {
-                    log->logUpdateSuccess(&memberNode->addr, true, message.transID, saved_message.key,
-                                          saved_message.value);
+        } else if (message.type == TRANSFER || message.type == TRANSFERUPDATE) {
+            transferKeyValue(message.key, message.value, message.replica, message.type == TRANSFER);
+            // a replayed hint is acknowledged whether or not it was newer, a read repair is not
+            if (message.transID != 0) {
+                Message response = Message(message.transID, memberNode->addr, REPLY, true);
+                emulNet->ENsend(&memberNode->addr, &message.fromAddr, response.toString());
+            }
+        } else if (message.type == MERKLE) {
+            handleMerkle(message);
+        } else if (message.type == STREAM) {
+            handleStream(message);
+        } else if (message.type == STREAMACK) {
+            handleStreamAck(message);
+        } else if (message.type == MULTIPUT) {
+            for (auto &entry: message.batch) {
+                bool succeed = entry.hint.empty() ? createKeyValue(entry.key, entry.value, entry.replica)
+                                                  : storeHint(CREATE, entry.hint, entry.key, entry.value, entry.replica);
+                if (succeed) {
+                    log->logCreateSuccess(&memberNode->addr, false, entry.transID, entry.key, entry.value);
+                } else {
+                    log->logCreateFail(&memberNode->addr, false, entry.transID, entry.key, entry.value);
                 }
-            } else {
-                if (saved_message.type == CREATE) {
-                    log->logCreateFail(&memberNode->addr, true, message.transID, saved_message.key,
-                                       saved_message.value);
-                } else if (saved_message.type == DELETE) {
-                    log->logDeleteFail(&memberNode->addr, true, message.transID, saved_message.key);
-                } else if (saved_message.type == UPDATE) {
-                    log->logUpdateFail(&memberNode->addr, true, message.transID, saved_message.key,
-                                       saved_message.value);
+                addToBatch(&message.fromAddr, MULTIREPLY, BatchEntry{entry.transID, "", "", PRIMARY, succeed});
+            }
+            flushBatches();
+        } else if (message.type == MULTIGET) {
+            for (auto &entry: message.batch) {
+                string stored = readKey(entry.key);
+                if (!stored.empty()) {
+                    log->logReadSuccess(&memberNode->addr, false, entry.transID, entry.key, Entry(stored).value);
+                } else {
+                    log->logReadFail(&memberNode->addr, false, entry.transID, entry.key);
                 }
+                addToBatch(&message.fromAddr, MULTIREPLY, BatchEntry{entry.transID, "", stored, PRIMARY, !stored.empty()});
+            }
+            flushBatches();
+        } else if (message.type == REPLY) {
+            // the replica of a replayed hint answers with the transID of the hint
+            if (!ackHint(message.transID, message.fromAddr)) {
+                handleReply(message.transID, message.fromAddr, message.success, "");
             }
-            this->transactionMap.erase(message.transID);
         } else if (message.type == READREPLY) {
-            Message &saved_message =(this->transactionMap.find(message.transID))->second;
-            if (message.success) {
-                log->logReadSuccess(&memberNode->addr, true, message.transID, saved_message.key, message.value);
-            } else {
-                log->logReadFail(&memberNode->addr, true, message.transID, saved_message.key);
+            handleReply(message.transID, message.fromAddr, !message.value.empty(), message.value);
+        } else if (message.type == MULTIREPLY) {
+            for (auto &entry: message.batch) {
+                handleReply(entry.transID, message.fromAddr, entry.success, entry.value);
             }
         }
     }
@@ -363,6 +1007,12 @@ void MP2Node::checkMessages() {
      * This function should also ensure all READ and UPDATE operation
      * get QUORUM replies
      */
+    checkTimeouts();
+    replayHints();
+    pumpStreams();
+    if (par->getcurrtime() >= nextAntiEntropy) {
+        startAntiEntropy();
+    }
 }
 
 /**
@@ -370,30 +1020,14 @@ void MP2Node::checkMessages() {
  *
  * DESCRIPTION: Find the replicas of the given keyfunction
  * 				This function is responsible for finding the replicas of a key
+ * 				with the placement strategy selected by par->PLACEMENT
+ *
+ * RETURNS:
+ * The replicas, primary first, valid until the next lookup or ring change.
+ * Empty if there are fewer than par->REPLICATION_FACTOR nodes.
  */
-vector<Node> MP2Node::findNodes(string key) {
-    size_t pos = hashFunction(key);
-    vector<Node> addr_vec;
-    if (ring.size() >= 3) {
-        // if pos <= min || pos > max, the leader is the min
-        if (pos <= ring.at(0).getHashCode() || pos > ring.at(ring.size() - 1).getHashCode()) {
-            addr_vec.emplace_back(ring.at(0));
-            addr_vec.emplace_back(ring.at(1));
-            addr_vec.emplace_back(ring.at(2));
-        } else {
-            // go through the ring until pos <= node
-            for (int i = 1; i < ring.size(); i++) {
-                Node addr = ring.at(i);
-                if (pos <= addr.getHashCode()) {
-                    addr_vec.emplace_back(addr);
-                    addr_vec.emplace_back(ring.at((i + 1) % ring.size()));
-                    addr_vec.emplace_back(ring.at((i + 2) % ring.size()));
-                    break;
-                }
-            }
-        }
-    }
-    return addr_vec;
+const vector<Node *> &MP2Node::findNodes(const string &key) {
+    return placement->findNodes(hashFunction(key));
 }
 
 /**
@@ -427,9 +1061,498 @@ int MP2Node::enqueueWrapper(void *env, char *buff, int size) {
  * 				The function does the following:
  *				1) Ensures that there are three "CORRECT" replicas of all the keys in spite of failures and joins
  *				Note:- "CORRECT" replicas implies that every key is replicated in its two neighboring nodes in the ring
+ *				The keys every pair of replicas should share change with the ring, so their Merkle trees are
+ *				rebuilt and an anti-entropy round starts right away instead of at the next interval.
+ *				Only the keys of the ranges the replicas disagree on are transferred, see handleMerkle.
+ *				The keys this node is no longer a replica of are handed over to their replicas, see rebalance.
  */
 void MP2Node::stabilizationProtocol() {
-    /*
-     * Implement this
-     */
+    merkleDirty = true;
+    nextAntiEntropy = par->getcurrtime();
+    rebalance();
+}
+
+/**
+ * FUNCTION NAME: storeTombstone
+ *
+ * DESCRIPTION: Applies a delete another replica streamed. The key is deleted unless it has been
+ * 				written after the delete, and the newest tombstone is kept.
+ */
+bool MP2Node::storeTombstone(const string &key, int deletedAt) {
+    string current = ht->read(key);
+    if (!current.empty() && Entry(current).timestamp > deletedAt) {
+        return false;
+    }
+
+    merkleDirty = true;
+    int &tombstone = tombstones[key];
+    tombstone = max(tombstone, deletedAt);
+    ht->deleteKey(key);
+    return true;
+}
+
+/**
+ * FUNCTION NAME: expireTombstones
+ *
+ * DESCRIPTION: Forgets the deletes older than TOMBSTONE_TTL
+ */
+void MP2Node::expireTombstones() {
+    for (auto it = tombstones.begin(); it != tombstones.end();) {
+        if (par->getcurrtime() - it->second > TOMBSTONE_TTL) {
+            it = tombstones.erase(it);
+            merkleDirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: addToMerkleTrees
+ *
+ * DESCRIPTION: Adds the version of a key this node replicates to the tree of each of its other replicas
+ */
+void MP2Node::addToMerkleTrees(const string &key, const string &version) {
+    uint64_t keyHash = hashFunction(key);
+    auto &replicas = placement->findNodes(keyHash);
+    bool replicated = false;
+    for (auto node: replicas) {
+        replicated |= *node->getAddress() == memberNode->addr;
+    }
+    if (!replicated) {
+        return;
+    }
+
+    for (auto node: replicas) {
+        if (!(*node->getAddress() == memberNode->addr)) {
+            merkleTrees[node->getAddress()->getAddress()].add(keyHash, key, version);
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: buildMerkleTrees
+ *
+ * DESCRIPTION: Rebuilds the trees from the local keys and tombstones. A key is hashed with its value
+ * 				and timestamp but not its replica type, which is different on every replica, a
+ * 				tombstone with the tick of the delete.
+ */
+void MP2Node::buildMerkleTrees() {
+    if (!merkleDirty) {
+        return;
+    }
+    merkleDirty = false;
+    merkleTrees.clear();
+
+    for (auto &pair: ht->hashTable) {
+        Entry entry(pair.second);
+        addToMerkleTrees(pair.first, entry.value + "::" + to_string(entry.timestamp));
+    }
+    for (auto &tombstone: tombstones) {
+        addToMerkleTrees(tombstone.first, "::deleted::" + to_string(tombstone.second));
+    }
+
+    for (auto &tree: merkleTrees) {
+        tree.second.seal();
+    }
+}
+
+/**
+ * FUNCTION NAME: startAntiEntropy
+ *
+ * DESCRIPTION: Sends the root of the tree this node keeps for every replication neighbour to it.
+ * 				Replicas that agree exchange nothing more than that.
+ */
+void MP2Node::startAntiEntropy() {
+    nextAntiEntropy = par->getcurrtime() + ANTI_ENTROPY_INTERVAL;
+    expireTombstones();
+    buildMerkleTrees();
+
+    set<string> sent;
+    for (auto *neighbors: {&hasMyReplicas, &haveReplicasOf}) {
+        for (auto &node: *neighbors) {
+            string address = node.getAddress()->getAddress();
+            if (node.nodeAddress == memberNode->addr || !sent.insert(address).second) {
+                continue;
+            }
+            auto tree = merkleTrees.find(address);
+            uint64_t root = tree == merkleTrees.end() ? 0 : tree->second.hash(1);
+            Message message(transIDs.next(), memberNode->addr, vector<pair<int, uint64_t>>{make_pair(1, root)});
+            emulNet->ENsend(&memberNode->addr, &node.nodeAddress, message.toString());
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: handleMerkle
+ *
+ * DESCRIPTION: Compares the tree nodes a neighbour sent with the tree kept for it. The hashes of
+ * 				the children of an inner node that differs go back to it, so the two replicas walk
+ * 				down the differing branches only. Whoever receives a differing leaf streams its keys
+ * 				and tombstones of those ranges to the neighbour, which applies the ones newer than its own. Both
+ * 				neighbours start rounds, so either side ends up receiving the leaves once.
+ */
+void MP2Node::handleMerkle(Message &message) {
+    buildMerkleTrees();
+    static const MerkleTree empty;
+    string from = message.fromAddr.getAddress();
+    auto found = merkleTrees.find(from);
+    const MerkleTree &tree = found == merkleTrees.end() ? empty : found->second;
+
+    vector<pair<int, uint64_t>> children;
+    vector<bool> staleLeaves(MERKLE_LEAVES, false);
+    bool stale = false;
+    for (auto &digest: message.digests) {
+        int index = digest.first;
+        if (index < 1 || index >= 2 * MERKLE_LEAVES || tree.hash(index) == digest.second) {
+            continue;
+        }
+        if (MerkleTree::isLeaf(index)) {
+            staleLeaves[index - MERKLE_LEAVES] = true;
+            stale = true;
+        } else {
+            children.emplace_back(2 * index, tree.hash(2 * index));
+            children.emplace_back(2 * index + 1, tree.hash(2 * index + 1));
+        }
+    }
+
+    if (!children.empty()) {
+        Message reply(message.transID, memberNode->addr, std::move(children));
+        emulNet->ENsend(&memberNode->addr, &message.fromAddr, reply.toString());
+    }
+    if (!stale) {
+        return;
+    }
+
+    // replica type of the sender for the keys of the differing leaves both replicate, -1 for the others
+    auto receiverIndex = [&](const string &key) {
+        uint64_t keyHash = hashFunction(key);
+        if (!staleLeaves[MerkleTree::leafOf(keyHash)]) {
+            return -1;
+        }
+        auto &replicas = placement->findNodes(keyHash);
+        int receiver = -1;
+        bool replicated = false;
+        for (size_t i = 0; i < replicas.size(); ++i) {
+            if (*replicas[i]->getAddress() == message.fromAddr) {
+                receiver = static_cast<int>(i);
+            }
+            replicated |= *replicas[i]->getAddress() == memberNode->addr;
+        }
+        return replicated ? receiver : -1;
+    };
+
+    vector<BatchEntry> range;
+    for (auto &pair: ht->hashTable) {
+        int receiver = receiverIndex(pair.first);
+        if (receiver >= 0) {
+            range.push_back(BatchEntry{0, pair.first, pair.second, getReplicaType(receiver), false, "", false});
+        }
+    }
+    for (auto &tombstone: tombstones) {
+        int receiver = receiverIndex(tombstone.first);
+        if (receiver >= 0) {
+            range.push_back(BatchEntry{0, tombstone.first, to_string(tombstone.second), getReplicaType(receiver),
+                                       false, "", true});
+        }
+    }
+    startStream(message.fromAddr, std::move(range), false, true);
+}
+
+/**
+ * FUNCTION NAME: rebalance
+ *
+ * DESCRIPTION: Streams the local keys this node no longer replicates after a ring change to their
+ * 				replicas, one stream per replica, and drops them once every stream has completed.
+ * 				Keys already being handed over are left to the streams carrying them.
+ */
+void MP2Node::rebalance() {
+    map<string, vector<BatchEntry>> ranges;
+    for (auto &pair: ht->hashTable) {
+        if (releases.count(pair.first)) {
+            continue;
+        }
+        auto &replicas = findNodes(pair.first);
+        bool replicated = false;
+        for (auto node: replicas) {
+            replicated |= *node->getAddress() == memberNode->addr;
+        }
+        if (replicas.empty() || replicated) {
+            continue;
+        }
+
+        for (size_t i = 0; i < replicas.size(); ++i) {
+            ranges[replicas[i]->getAddress()->getAddress()].push_back(
+                    BatchEntry{0, pair.first, pair.second, getReplicaType(i), false});
+        }
+        releases[pair.first] = static_cast<int>(replicas.size());
+    }
+
+    for (auto &range: ranges) {
+        startStream(Address(range.first), std::move(range.second), true, true);
+    }
+}
+
+/**
+ * FUNCTION NAME: startStream
+ *
+ * DESCRIPTION: Splits the entries into chunks that fit a message each and starts sending them.
+ * 				A paced stream keeps at most STREAM_WINDOW chunks unacknowledged and sends the rest
+ * 				as the acknowledgements arrive. Otherwise every chunk is sent at once and the stream
+ * 				is forgotten, for a node that will not be around for the acknowledgements.
+ */
+void MP2Node::startStream(const Address &to, vector<BatchEntry> entries, bool release, bool paced) {
+    if (entries.empty()) {
+        return;
+    }
+
+    uint64_t streamID = transIDs.next();
+    Stream stream{to, std::move(entries), vector<size_t>{0}, 0, 0, 0, par->getcurrtime(), release};
+
+    // the header is measured with the longest sequence number it can carry
+    Message chunk(streamID, memberNode->addr, std::numeric_limits<int>::max(), false, vector<BatchEntry>());
+    size_t header = chunk.toString().size();
+    size_t bytes = header;
+    for (size_t i = 0; i < stream.entries.size(); ++i) {
+        size_t size = chunk.delimiter.size() + chunk.entryToString(stream.entries[i]).size();
+        if (i > stream.chunks.back() && bytes + size > maxMessageSize()) {
+            stream.chunks.push_back(i);
+            bytes = header;
+        }
+        bytes += size;
+    }
+    stream.chunks.push_back(stream.entries.size());
+
+    if (!paced) {
+        while (stream.sent + 1 < static_cast<int>(stream.chunks.size())) {
+            sendChunks(streamID, stream);
+            stream.acked = stream.sent;
+        }
+        return;
+    }
+
+    sendChunks(streamID, streams.emplace(streamID, std::move(stream)).first->second);
+}
+
+/**
+ * FUNCTION NAME: sendChunks
+ *
+ * DESCRIPTION: Sends the next chunks of the stream the window has room for
+ */
+void MP2Node::sendChunks(uint64_t streamID, Stream &stream) {
+    int count = static_cast<int>(stream.chunks.size()) - 1;
+    while (stream.sent < count && stream.sent - stream.acked < STREAM_WINDOW) {
+        auto first = stream.entries.begin() + stream.chunks[stream.sent];
+        auto last = stream.entries.begin() + stream.chunks[stream.sent + 1];
+        Message chunk(streamID, memberNode->addr, stream.sent, stream.sent + 1 == count, vector<BatchEntry>(first, last));
+        emulNet->ENsend(&memberNode->addr, &stream.to, chunk.toString());
+        ++stream.sent;
+    }
+}
+
+/**
+ * FUNCTION NAME: finishStream
+ *
+ * DESCRIPTION: Forgets a stream. Once the last stream carrying a released key has completed the key
+ * 				is dropped, unless the ring has made this node one of its replicas again meanwhile.
+ * 				A key of a failed stream is kept and handed over again after the next ring change.
+ */
+void MP2Node::finishStream(map<uint64_t, Stream>::iterator it, bool completed) {
+    Stream &stream = it->second;
+    if (!stream.release) {
+        streams.erase(it);
+        return;
+    }
+
+    for (auto &entry: stream.entries) {
+        auto release = releases.find(entry.key);
+        if (release == releases.end()) {
+            continue;
+        }
+        if (!completed) {
+            releases.erase(release);
+            continue;
+        }
+        if (--release->second > 0) {
+            continue;
+        }
+        releases.erase(release);
+
+        bool replicated = false;
+        for (auto node: findNodes(entry.key)) {
+            replicated |= *node->getAddress() == memberNode->addr;
+        }
+        if (!replicated) {
+            merkleDirty = true;
+            ht->deleteKey(entry.key);
+        }
+    }
+    streams.erase(it);
+}
+
+/**
+ * FUNCTION NAME: handleStream
+ *
+ * DESCRIPTION: Receiver side of a stream. EmulNet does not keep the order of the messages, so the
+ * 				chunks of the window are collected in any order. Every chunk is answered with the
+ * 				last one received in order, the sender sends the ones after it again if they are
+ * 				lost. The keys are stored together once every chunk has arrived, each one unless a
+ * 				newer version is already here. A stored stream is remembered for as long as the
+ * 				sender can retry, so that chunks sent again after a lost last ack are acknowledged.
+ */
+void MP2Node::handleStream(Message &message) {
+    string id = message.fromAddr.getAddress() + "#" + to_string(message.transID);
+    auto it = incomingStreams.find(id);
+    if (it == incomingStreams.end()) {
+        it = incomingStreams.emplace(id, IncomingStream{0, -1, vector<BatchEntry>(), map<int, vector<BatchEntry>>(),
+                                                        par->getcurrtime(), false}).first;
+    }
+
+    IncomingStream &stream = it->second;
+    stream.receivedAt = par->getcurrtime();
+    if (message.success) {
+        stream.last = message.sequence;
+    }
+    if (message.sequence >= stream.expected) {
+        stream.early[message.sequence] = std::move(message.batch);
+    }
+    for (auto chunk = stream.early.begin(); chunk != stream.early.end() && chunk->first == stream.expected;
+         chunk = stream.early.erase(chunk)) {
+        stream.entries.insert(stream.entries.end(), chunk->second.begin(), chunk->second.end());
+        ++stream.expected;
+    }
+
+    if (stream.expected == 0) {
+        return;
+    }
+    Message ack(message.transID, memberNode->addr, stream.expected - 1);
+    emulNet->ENsend(&memberNode->addr, &message.fromAddr, ack.toString());
+
+    if (stream.last >= 0 && stream.expected > stream.last && !stream.applied) {
+        for (auto &entry: stream.entries) {
+            if (entry.deleted) {
+                storeTombstone(entry.key, stoi(entry.value));
+            } else {
+                transferKeyValue(entry.key, entry.value, entry.replica);
+            }
+        }
+        // the last ack can be lost, the chunks sent again are acknowledged until the stream expires
+        stream.applied = true;
+        stream.entries.clear();
+    }
+}
+
+/**
+ * FUNCTION NAME: handleStreamAck
+ *
+ * DESCRIPTION: Slides the window of the stream past the acknowledged chunks
+ */
+void MP2Node::handleStreamAck(Message &message) {
+    auto it = streams.find(message.transID);
+    if (it == streams.end() || !(it->second.to == message.fromAddr)) {
+        return;
+    }
+
+    Stream &stream = it->second;
+    if (message.sequence + 1 > stream.acked) {
+        stream.acked = message.sequence + 1;
+        stream.retries = 0;
+        stream.progressAt = par->getcurrtime();
+    }
+    if (stream.acked + 1 == static_cast<int>(stream.chunks.size())) {
+        finishStream(it, true);
+        return;
+    }
+    sendChunks(it->first, stream);
+}
+
+/**
+ * FUNCTION NAME: pumpStreams
+ *
+ * DESCRIPTION: Sends the unacknowledged chunks of the streams that made no progress for
+ * 				STREAM_TIMEOUT ticks again. A stream is given up after STREAM_RETRIES attempts or
+ * 				once its receiver is suspected, a stream being received once its sender had the time
+ * 				for all of them.
+ */
+void MP2Node::pumpStreams() {
+    int now = par->getcurrtime();
+    for (auto it = streams.begin(); it != streams.end();) {
+        Stream &stream = it->second;
+        auto current = it++;
+        if (now - stream.progressAt < STREAM_TIMEOUT) {
+            continue;
+        }
+        if (stream.retries >= STREAM_RETRIES || isSuspected(&stream.to)) {
+            finishStream(current, false);
+            continue;
+        }
+        ++stream.retries;
+        stream.progressAt = now;
+        stream.sent = stream.acked;
+        sendChunks(current->first, stream);
+    }
+
+    for (auto it = incomingStreams.begin(); it != incomingStreams.end();) {
+        if (now - it->second.receivedAt > STREAM_TIMEOUT * (STREAM_RETRIES + 1)) {
+            it = incomingStreams.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: merge
+ *
+ * DESCRIPTION: Adds the operations of the other stats to these
+ */
+void OperationStats::merge(const OperationStats &other) {
+    latency.merge(other.latency);
+    fanOut.merge(other.fanOut);
+    retries.merge(other.retries);
+    failures += other.failures;
+}
+
+/**
+ * FUNCTION NAME: report
+ *
+ * DESCRIPTION: Writes the percentiles of the operations to the stats log, nothing without operations
+ */
+void OperationStats::report(Log *log, Address *addr, const string &scope, MessageType type) {
+    static const char *names[] = {"create", "read", "update", "delete"};
+    if (latency.count() == 0) {
+        return;
+    }
+    log->LOG(addr, "#STATSLOG# %s %s: operations %ld, unsuccessful %ld, latency p50 %ld p90 %ld p99 %ld max %ld mean %.2f, fan-out p50 %ld max %ld, retries p50 %ld p99 %ld max %ld",
+             scope.c_str(), names[type], latency.count(), failures, latency.percentile(50), latency.percentile(90),
+             latency.percentile(99), latency.max(), latency.mean(), fanOut.percentile(50), fanOut.max(),
+             retries.percentile(50), retries.percentile(99), retries.max());
+}
+
+/**
+ * FUNCTION NAME: reportOperationStats
+ *
+ * DESCRIPTION: Exports the operations this node coordinated, by type
+ */
+void MP2Node::reportOperationStats() {
+    for (int type = CREATE; type <= DELETE; ++type) {
+        operationStats[type].report(log, &memberNode->addr, "coordinator", static_cast<MessageType>(type));
+    }
+}
+
+/**
+ * FUNCTION NAME: reportClusterOperationStats
+ *
+ * DESCRIPTION: Exports the operations of all the nodes together, by type
+ */
+void MP2Node::reportClusterOperationStats(MP2Node **nodes, int count, Log *log) {
+    Address addr;
+    addr.init();
+    for (int type = CREATE; type <= DELETE; ++type) {
+        OperationStats cluster;
+        for (int i = 0; i < count; ++i) {
+            cluster.merge(nodes[i]->getOperationStats(static_cast<MessageType>(type)));
+        }
+        cluster.report(log, &addr, "cluster", static_cast<MessageType>(type));
+    }
 }
@@ -18,11 +18,84 @@
 #include "Params.h"
 #include "Message.h"
 #include "Queue.h"
+#include "Placement.h"
+#include "TimerWheel.h"
+#include "MerkleTree.h"
+#include "TransIDGenerator.h"
+#include "Histogram.h"
+#include "MP1Node.h"
 
+#include <deque>
+#include <functional>
+#include <limits>
+#include <set>
 #include <unordered_map>
 
 using std::unordered_map;
 
+/**
+ * Macros
+ */
+// ticks a coordinator waits for the quorum of a transaction
+#define TRANSACTION_TIMEOUT 10
+#define TRANSACTION_WHEEL_SLOTS 16
+// a read asks READ_QUORUM replicas and hedges with the next one once this percentile of the reply
+// latencies has passed without quorum. The latencies are halved once LATENCY_WINDOW have been seen
+#define HEDGE_PERCENTILE 95
+#define LATENCY_WINDOW 1024
+// hints a node keeps for unavailable replicas, and for how many ticks. A replayed hint is sent
+// again every HINT_RETRY ticks until its replica acknowledges it
+#define MAX_HINTS 1000
+#define HINT_TTL 100
+#define HINT_RETRY 5
+// ticks between two anti-entropy rounds with the replication neighbours
+#define ANTI_ENTROPY_INTERVAL 10
+// ticks a deleted key is remembered, so anti-entropy does not bring it back from a replica that missed
+// the delete. Longer than a failed replica takes to be removed plus an anti-entropy round
+#define TOMBSTONE_TTL (2 * (TREMOVE + ANTI_ENTROPY_INTERVAL))
+// chunks of a key range stream sent before the receiver has acknowledged them, and the ticks without
+// progress after which the unacknowledged ones are sent again, at most STREAM_RETRIES times in a row
+#define STREAM_WINDOW 4
+#define STREAM_TIMEOUT 5
+#define STREAM_RETRIES 3
+
+/**
+ * STRUCT NAME: Completion
+ *
+ * DESCRIPTION: Outcome of a client operation, handed to its completion callback
+ */
+struct Completion {
+    // handle the client API returned for the operation
+    uint64_t transID;
+    MessageType type;
+    string key;
+    // value written, or the newest value read
+    string value;
+    bool success;
+    // ticks the operation was issued and decided at
+    int startTime;
+    int completionTime;
+};
+
+typedef std::function<void(const Completion &)> CompletionCallback;
+
+/**
+ * STRUCT NAME: OperationStats
+ *
+ * DESCRIPTION: What the client operations of one type cost their coordinators: the ticks from issue
+ * 				to the quorum decision, the replicas asked and the requests resent to further replicas
+ */
+struct OperationStats {
+    Histogram latency;
+    Histogram fanOut;
+    Histogram retries;
+    long failures = 0;
+
+    void merge(const OperationStats &other);
+
+    void report(Log *log, Address *addr, const string &scope, MessageType type);
+};
+
 /**
  * CLASS NAME: MP2Node
  *
@@ -35,12 +108,16 @@ using std::unordered_map;
  */
 class MP2Node {
 private:
-    // Vector holding the next two neighbors in the ring who have my replicas
+    // Vector holding the nodes that replicate the arcs I am the primary of
     vector<Node> hasMyReplicas;
-    // Vector holding the previous two neighbors in the ring whose replicas I have
+    // Vector holding the primaries of the arcs I replicate
     vector<Node> haveReplicasOf;
-    // Ring
-    vector<Node> ring;
+    // Placement of the keys on the nodes of the ring
+    PlacementStrategy *placement;
+    // Set when a membership change has altered the ring, cleared once the stabilization protocol ran
+    bool ringChanged;
+    // Membership epoch the ring reflects
+    unsigned long ringEpoch;
     // Hash Table
     HashTable *ht;
     // Member representing this member
@@ -51,8 +128,174 @@ private:
     EmulNet *emulNet;
     // Object of Log
     Log *log;
-    // transaction holder
-    unordered_map<int, Message> transactionMap;
+    // ids of the transactions, streams and anti-entropy rounds this node starts
+    TransIDGenerator transIDs;
+    // A client operation this node coordinates, decided once quorum replies agree
+    // or quorum can no longer be reached
+    struct Transaction {
+        MessageType type;
+        string key;
+        string value;
+        int replicas;
+        int quorum;
+        // replicas asked so far, the replicas of a read not asked yet in preference order
+        int asked;
+        deque<Address> backups;
+        int replies;
+        int successes;
+        // newest entry read so far
+        string latest;
+        // entry every replica answered a read with, empty if it has none
+        vector<pair<Address, string>> versions;
+        // set once a read is decided but still waits for replies to repair stale replicas
+        bool decided;
+        // set once the transaction has reached quorum, only such reads repair replicas
+        bool succeeded;
+        int startTime;
+        // READ requests sent to backup replicas
+        int retries;
+        CompletionCallback done;
+    };
+    // transaction holder, transID -> open transaction
+    unordered_map<uint64_t, Transaction> transactions;
+    // deadlines of the open transactions, keyed by transID
+    TimerWheel deadlines;
+    vector<uint64_t> expiredTransactions;
+    // when to hedge the open reads, keyed by transID
+    TimerWheel hedges;
+    // replies by latency in ticks, the last bucket takes the replies at or after TRANSACTION_TIMEOUT
+    vector<long> replyLatencies;
+    long replyLatencySamples;
+    // operations this node coordinated, by type CREATE to DELETE
+    OperationStats operationStats[DELETE + 1];
+
+    void startTransaction(uint64_t transID, MessageType type, const string &key, const string &value, int replicas,
+                          const CompletionCallback &done);
+
+    void handleReply(uint64_t transID, Address &from, bool success, const string &entry);
+
+    // batch messages under construction, by address of the receiver
+    struct Batch {
+        Message message;
+        size_t bytes;
+    };
+    map<string, Batch> batches;
+
+    void addToBatch(Address *to, MessageType type, const BatchEntry &entry);
+
+    // targets of the write being sent and the replicas they stand in for, see findWriteTargets
+    vector<Node *> writeTargets;
+    vector<string> writeHints;
+    vector<Node *> successors;
+
+    // a write kept for a replica that was unavailable
+    struct Hint {
+        // CREATE or UPDATE
+        MessageType type;
+        Address owner;
+        string key;
+        string entry;
+        int storedAt;
+        // transID of the replay, tick it was last sent at or -1
+        uint64_t transID;
+        int sentAt;
+    };
+    deque<Hint> hints;
+
+    bool isSuspected(Address *address);
+
+    void findWriteTargets(const string &key);
+
+    bool storeHint(MessageType type, const string &owner, const string &key, const string &value, ReplicaType replica);
+
+    void replayHints();
+
+    bool ackHint(uint64_t transID, Address &from);
+
+    // Merkle trees of the keys this node shares with each replication neighbour, by address.
+    // Rebuilt before their next use once the hash table or the ring has changed
+    map<string, MerkleTree> merkleTrees;
+    bool merkleDirty;
+    int nextAntiEntropy;
+    // tick of the delete by deleted key, see TOMBSTONE_TTL
+    unordered_map<string, int> tombstones;
+
+    bool storeTombstone(const string &key, int deletedAt);
+
+    void expireTombstones();
+
+    void addToMerkleTrees(const string &key, const string &version);
+
+    void buildMerkleTrees();
+
+    void startAntiEntropy();
+
+    void handleMerkle(Message &message);
+
+    // a key range this node streams to another node, in chunks of at most one message each
+    struct Stream {
+        Address to;
+        // key, entry and replica type of the receiver for every key
+        vector<BatchEntry> entries;
+        // index of the first entry of every chunk, followed by the number of entries
+        vector<size_t> chunks;
+        // chunks acknowledged, chunks sent
+        int acked;
+        int sent;
+        int retries;
+        // tick the stream last made progress at
+        int progressAt;
+        // drop the keys this node does not replicate any more once the stream completes
+        bool release;
+    };
+    // streams being sent, by stream id
+    map<uint64_t, Stream> streams;
+    // a key range being received, applied at once when all of its chunks have arrived
+    struct IncomingStream {
+        // next chunk in order, the last chunk once it is known
+        int expected;
+        int last;
+        vector<BatchEntry> entries;
+        // chunks received ahead of the next one in order
+        map<int, vector<BatchEntry>> early;
+        int receivedAt;
+        // stored already, kept until it expires to acknowledge the chunks the sender sends again
+        bool applied;
+    };
+    // streams being received, by address of the sender and stream id
+    map<string, IncomingStream> incomingStreams;
+    // keys handed over to their new replicas, by number of streams still carrying them
+    unordered_map<string, int> releases;
+
+    size_t maxMessageSize();
+
+    void startStream(const Address &to, vector<BatchEntry> entries, bool release, bool paced);
+
+    void sendChunks(uint64_t streamID, Stream &stream);
+
+    void finishStream(map<uint64_t, Stream>::iterator it, bool completed);
+
+    void handleStream(Message &message);
+
+    void handleStreamAck(Message &message);
+
+    void pumpStreams();
+
+    void rebalance();
+
+    void flushBatches();
+
+    void finishTransaction(uint64_t transID, bool success);
+
+    void closeTransaction(unordered_map<uint64_t, Transaction>::iterator it);
+
+    bool sendBackup(uint64_t transID, Transaction &transaction);
+
+    void recordReplyLatency(int ticks);
+
+    int hedgeDelay();
+
+    void checkTimeouts();
 
 public:
     MP2Node(Member *memberNode, Params *par, EmulNet *emulNet, Log *log, Address *addressOfMember);
@@ -64,20 +307,44 @@ public:
     // ring functionalities
     void updateRing();
 
-    vector<Node> getMembershipList();
+    bool addToRing(const Address &address);
+
+    bool removeFromRing(const Address &address);
+
+    unsigned long getRingEpoch() {
+        return ringEpoch;
+    }
 
-    size_t hashFunction(string key);
+    uint64_t hashFunction(const string &key);
 
     void findNeighbors();
 
-    // client side CRUD APIs
-    void clientCreate(string key, string value);
+    // client side CRUD APIs, they return the handle of the operation and call done once it is decided
+    uint64_t clientCreate(string key, string value, CompletionCallback done = CompletionCallback());
+
+    uint64_t clientRead(string key, CompletionCallback done = CompletionCallback());
 
-    void clientRead(string key);
+    uint64_t clientUpdate(string key, string value, CompletionCallback done = CompletionCallback());
 
-    void clientUpdate(string key, string value);
+    uint64_t clientDelete(string key, CompletionCallback done = CompletionCallback());
 
-    void clientDelete(string key);
+    // batched client side APIs, one message per replica for all the keys. done is called for every key
+    vector<uint64_t> multiPut(const vector<pair<string, string>> &pairs, CompletionCallback done = CompletionCallback());
+
+    vector<uint64_t> multiGet(const vector<string> &keys, CompletionCallback done = CompletionCallback());
+
+    size_t pendingOperations() {
+        return transactions.size();
+    }
+
+    const OperationStats &getOperationStats(MessageType type) {
+        return operationStats[type];
+    }
+
+    // export the operation histograms of this node, and the ones of all nodes together
+    void reportOperationStats();
+
+    static void reportClusterOperationStats(MP2Node **nodes, int count, Log *log);
 
     // receive messages from Emulnet
     bool recvLoop();
@@ -91,7 +358,7 @@ public:
     void dispatchMessages(Message message);
 
     // find the addresses of nodes that are responsible for a key
-    vector<Node> findNodes(string key);
+    const vector<Node *> &findNodes(const string &key);
 
     // server
     bool createKeyValue(string key, string value, ReplicaType replica);
@@ -102,6 +369,11 @@ public:
 
     bool deletekey(string key);
 
+    bool transferKeyValue(string key, string entry, ReplicaType replica, bool create = true);
+
+    // hand the keys over to their next owners before leaving the ring
+    void handOff();
+
     // stabilization protocol - handle multiple failures
     void stabilizationProtocol();
 
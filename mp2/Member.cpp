@@ -139,6 +139,144 @@ void MemberListEntry::settimestamp(long timestamp) {
 	this->timestamp = timestamp;
 }
 
+/**
+ * Constructor
+ */
+MembershipEvent::MembershipEvent(MembershipEventType type, const Address &addr, unsigned long epoch, long time): type(type), addr(addr), epoch(epoch), time(time) {}
+
+/**
+ * FUNCTION NAME: clear
+ *
+ * DESCRIPTION: Drop all the rows
+ */
+void MembershipTable::clear() {
+	ids.clear();
+	ports.clear();
+	heartbeats.clear();
+	timestamps.clear();
+}
+
+/**
+ * FUNCTION NAME: find
+ *
+ * DESCRIPTION: Returns the position of the row of id, or size() if there is none
+ */
+size_t MembershipTable::find(int id) const {
+	auto it = lower_bound(ids.begin(), ids.end(), id);
+	if (it == ids.end() || *it != id) {
+		return ids.size();
+	}
+	return static_cast<size_t>(it - ids.begin());
+}
+
+/**
+ * FUNCTION NAME: insert
+ *
+ * DESCRIPTION: Inserts the row at its place in id order and returns its position.
+ * 				The row of an id that is already present is overwritten.
+ */
+size_t MembershipTable::insert(const MemberListEntry &entry) {
+	auto position = static_cast<size_t>(lower_bound(ids.begin(), ids.end(), entry.id) - ids.begin());
+	if (position == ids.size() || ids[position] != entry.id) {
+		ids.insert(ids.begin() + position, entry.id);
+		ports.insert(ports.begin() + position, entry.port);
+		heartbeats.insert(heartbeats.begin() + position, entry.heartbeat);
+		timestamps.insert(timestamps.begin() + position, entry.timestamp);
+	} else {
+		ports[position] = entry.port;
+		update(position, entry.heartbeat, entry.timestamp);
+	}
+	return position;
+}
+
+/**
+ * FUNCTION NAME: erase
+ *
+ * DESCRIPTION: Removes the row at position, the rows behind it move up by one
+ */
+void MembershipTable::erase(size_t position) {
+	ids.erase(ids.begin() + position);
+	ports.erase(ports.begin() + position);
+	heartbeats.erase(heartbeats.begin() + position);
+	timestamps.erase(timestamps.begin() + position);
+}
+
+/**
+ * FUNCTION NAME: update
+ *
+ * DESCRIPTION: setter
+ */
+void MembershipTable::update(size_t position, long heartbeat, long timestamp) {
+	heartbeats[position] = heartbeat;
+	timestamps[position] = timestamp;
+}
+
+/**
+ * FUNCTION NAME: entry
+ *
+ * DESCRIPTION: Returns a copy of the row at position
+ */
+MemberListEntry MembershipTable::entry(size_t position) const {
+	return MemberListEntry(ids[position], ports[position], heartbeats[position], timestamps[position]);
+}
+
+/**
+ * FUNCTION NAME: address
+ *
+ * DESCRIPTION: Returns the Address of the row at position
+ */
+Address MembershipTable::address(size_t position) const {
+	Address address;
+	address.init();
+	memcpy(&address.addr[0], &ids[position], sizeof(int));
+	memcpy(&address.addr[4], &ports[position], sizeof(short));
+	return address;
+}
+
+/**
+ * FUNCTION NAME: findFresh
+ *
+ * DESCRIPTION: Replaces positions by the positions of the rows at most age old, i.e. now - timestamp <= age.
+ * 				Only the timestamp column is read. Positions are written unconditionally and the count
+ * 				advanced by the comparison, so the loop has no data dependent branch.
+ * 				positions only allocates when it grows.
+ */
+void MembershipTable::findFresh(long now, long age, vector<size_t> &positions) const {
+	const long threshold = now - age;
+	const size_t count = timestamps.size();
+	positions.resize(count);
+	size_t *out = positions.data();
+	size_t n = 0;
+	for (size_t i = 0; i < count; ++i) {
+		out[n] = i;
+		n += timestamps[i] >= threshold;
+	}
+	positions.resize(n);
+}
+
+/**
+ * FUNCTION NAME: mergeMaxHeartbeat
+ *
+ * DESCRIPTION: Merges count incoming heartbeats into the rows starting at begin, incoming[i] belonging
+ * 				to row begin + i. A row whose heartbeat is exceeded takes the incoming heartbeat and the
+ * 				timestamp now, and its position is appended to updated.
+ */
+void MembershipTable::mergeMaxHeartbeat(size_t begin, const long *incoming, size_t count, long now, vector<size_t> &updated) {
+	long *heartbeat = heartbeats.data() + begin;
+	long *timestamp = timestamps.data() + begin;
+	size_t n = updated.size();
+	updated.resize(n + count);
+	size_t *out = updated.data();
+	for (size_t i = 0; i < count; ++i) {
+		bool newer = incoming[i] > heartbeat[i];
+		heartbeat[i] = newer ? incoming[i] : heartbeat[i];
+		timestamp[i] = newer ? now : timestamp[i];
+		out[n] = begin + i;
+		n += newer;
+	}
+	updated.resize(n);
+}
+
 /**
  * Copy Constructor
  */
@@ -152,9 +290,10 @@ Member::Member(const Member &anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
-	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
+	this->membershipEvents = anotherMember.membershipEvents;
+	this->membershipEpoch = anotherMember.membershipEpoch;
 }
 
 /**
@@ -170,8 +309,9 @@ Member& Member::operator =(const Member& anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
-	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
 	this->mp2q = anotherMember.mp2q;
+	this->membershipEvents = anotherMember.membershipEvents;
+	this->membershipEpoch = anotherMember.membershipEpoch;
 	return *this;
 }
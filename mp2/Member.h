@@ -80,6 +80,63 @@ public:
 	void settimestamp(long timestamp);
 };
 
+/**
+ * Membership change types
+ */
+enum MembershipEventType {
+	MEMBER_JOINED,
+	MEMBER_LEFT,
+	MEMBER_FAILED
+};
+
+/**
+ * CLASS NAME: MembershipEvent
+ *
+ * DESCRIPTION: Change of the membership list published by the membership protocol
+ */
+class MembershipEvent {
+public:
+	MembershipEventType type;
+	Address addr;
+	// membership epoch after this change
+	unsigned long epoch;
+	// time the change was seen at
+	long time;
+	MembershipEvent(MembershipEventType type, const Address &addr, unsigned long epoch, long time);
+};
+
+/**
+ * CLASS NAME: MembershipTable
+ *
+ * DESCRIPTION: Membership list stored column by column and kept sorted by id.
+ * 				Each field lives in its own contiguous array, so the scans over heartbeats
+ * 				and timestamps read nothing but the column they need.
+ * 				Rows are identified by their position, which changes on insert and erase.
+ */
+class MembershipTable {
+private:
+	vector<int> ids;
+	vector<short> ports;
+	vector<long> heartbeats;
+	vector<long> timestamps;
+public:
+	size_t size() const { return ids.size(); }
+	bool empty() const { return ids.empty(); }
+	void clear();
+	size_t find(int id) const;
+	size_t insert(const MemberListEntry &entry);
+	void erase(size_t position);
+	int getid(size_t position) const { return ids[position]; }
+	long getheartbeat(size_t position) const { return heartbeats[position]; }
+	long gettimestamp(size_t position) const { return timestamps[position]; }
+	void update(size_t position, long heartbeat, long timestamp);
+	MemberListEntry entry(size_t position) const;
+	Address address(size_t position) const;
+	// positions of the rows at most age old
+	void findFresh(long now, long age, vector<size_t> &positions) const;
+	void mergeMaxHeartbeat(size_t begin, const long *incoming, size_t count, long now, vector<size_t> &updated);
+};
+
 /**
  * CLASS NAME: Member
  *
@@ -105,17 +162,19 @@ public:
 	// counter for ping timeout
 	int timeOutCounter;
 	// Membership table
-	vector<MemberListEntry> memberList;
-	// My position in the membership table
-	vector<MemberListEntry>::iterator myPos;
+	MembershipTable memberList;
 	// Queue for failure detection messages
 	queue<q_elt> mp1q;
 	// Queue for KVstore messages
 	queue<q_elt> mp2q;
+	// Membership changes published by the membership protocol, drained by the KVstore
+	queue<MembershipEvent> membershipEvents;
+	// Incremented on every published membership change
+	unsigned long membershipEpoch;
 	/**
 	 * Constructor
 	 */
-	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0) {}
+	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0), membershipEpoch(0) {}
 	// copy constructor
 	Member(const Member &anotherMember);
 	// Assignment operator overloading
@@ -0,0 +1,59 @@
+/**********************************
+ * FILE NAME: MerkleTree.cpp
+ *
+ * DESCRIPTION: Definition of MerkleTree class functions
+ **********************************/
+
+#include "MerkleTree.h"
+
+/**
+ * Constructor
+ */
+MerkleTree::MerkleTree() : nodes(2 * MERKLE_LEAVES, 0) {}
+
+/**
+ * FUNCTION NAME: leafOf
+ *
+ * DESCRIPTION: Leaf of the range the position of the key falls in, from its top bits
+ */
+int MerkleTree::leafOf(uint64_t keyHash) {
+    int bits = 0;
+    while ((1 << bits) < MERKLE_LEAVES) {
+        ++bits;
+    }
+    return bits == 0 ? 0 : static_cast<int>(keyHash >> (64 - bits));
+}
+
+/**
+ * FUNCTION NAME: add
+ *
+ * DESCRIPTION: Adds the hash of the key and its version to the leaf of the key
+ */
+void MerkleTree::add(uint64_t keyHash, const string &key, const string &version) {
+    string bytes = key + '\0' + version;
+    nodes[MERKLE_LEAVES + leafOf(keyHash)] += hashBytes(bytes.data(), bytes.size());
+}
+
+/**
+ * FUNCTION NAME: seal
+ *
+ * DESCRIPTION: Hashes the children of every inner node, bottom up
+ */
+void MerkleTree::seal() {
+    for (int i = MERKLE_LEAVES - 1; i >= 1; --i) {
+        uint64_t children[2] = {nodes[2 * i], nodes[2 * i + 1]};
+        nodes[i] = children[0] == 0 && children[1] == 0 ? 0 : hashBytes(children, sizeof(children));
+    }
+}
+
+/**
+ * FUNCTION NAME: hash
+ *
+ * DESCRIPTION: Hash of the node, 0 for indexes outside of the tree
+ */
+uint64_t MerkleTree::hash(int index) const {
+    if (index < 1 || index >= static_cast<int>(nodes.size())) {
+        return 0;
+    }
+    return nodes[index];
+}
@@ -0,0 +1,51 @@
+/**********************************
+ * FILE NAME: MerkleTree.h
+ *
+ * DESCRIPTION: Hash tree over the keys of a key value store,
+ * 				used to find the key ranges two replicas disagree on
+ **********************************/
+
+#ifndef MERKLETREE_H_
+#define MERKLETREE_H_
+
+#include "stdincludes.h"
+#include "Node.h"
+
+/**
+ * Macros
+ */
+// key ranges of a tree, a power of two
+#define MERKLE_LEAVES 64
+
+/**
+ * CLASS NAME: MerkleTree
+ *
+ * DESCRIPTION: Complete binary tree in heap layout: the root is node 1, the children of node i
+ * 				are 2i and 2i + 1 and leaf l is node MERKLE_LEAVES + l. Leaf l covers the l-th of
+ * 				MERKLE_LEAVES equal ranges of the 64 bit ring. A leaf hashes its keys with a sum,
+ * 				so the order they are added in does not matter. Empty subtrees hash to 0, which
+ * 				makes a tree without keys equal to a default constructed one.
+ */
+class MerkleTree {
+private:
+    vector<uint64_t> nodes;
+
+public:
+    MerkleTree();
+
+    static int leafOf(uint64_t keyHash);
+
+    static bool isLeaf(int index) {
+        return index >= MERKLE_LEAVES;
+    }
+
+    // adds the version of the key, identified by its value and timestamp, to its leaf
+    void add(uint64_t keyHash, const string &key, const string &version);
+
+    // computes the inner nodes once all the keys have been added
+    void seal();
+
+    uint64_t hash(int index) const;
+};
+
+#endif /* MERKLETREE_H_ */
@@ -8,12 +8,20 @@
 /**
  * Constructor
  */
-// transID::fromAddr::CREATE::key::value::ReplicaType
+// transID::fromAddr::CREATE::key::value::ReplicaType[::hint]
 // transID::fromAddr::READ::key
-// transID::fromAddr::UPDATE::key::value::ReplicaType
+// transID::fromAddr::UPDATE::key::value::ReplicaType[::hint]
 // transID::fromAddr::DELETE::key
 // transID::fromAddr::REPLY::sucess
 // transID::fromAddr::READREPLY::value
+// transID::fromAddr::TRANSFER::key::entry::ReplicaType
+// transID::fromAddr::TRANSFERUPDATE::key::entry::ReplicaType
+// transID::fromAddr::MULTIPUT::(transID::key::value::ReplicaType::hint)*
+// transID::fromAddr::MULTIGET::(transID::key)*
+// transID::fromAddr::MULTIREPLY::(transID::sucess::entry)*
+// transID::fromAddr::MERKLE::(index::hash)*
+// transID::fromAddr::STREAM::sequence::last::(key::entry::ReplicaType::deleted)*
+// transID::fromAddr::STREAMACK::sequence
 Message::Message(string message){
 	this->delimiter = "::";
 	vector<string> tuple;
@@ -27,17 +35,21 @@ Message::Message(string message){
 	}
 	tuple.push_back(message.substr(start));
 
-	transID = stoi(tuple.at(0));
+	transID = stoull(tuple.at(0));
 	Address addr(tuple.at(1));
 	fromAddr = addr;
 	type = static_cast<MessageType>(stoi(tuple.at(2)));
 	switch(type){
 		case CREATE:
 		case UPDATE:
+		case TRANSFER:
+		case TRANSFERUPDATE:
 			key = tuple.at(3);
 			value = tuple.at(4);
 			if (tuple.size() > 5)
 				replica = static_cast<ReplicaType>(stoi(tuple.at(5)));
+			if (tuple.size() > 6)
+				hint = tuple.at(6);
 			break;
 		case READ:
 		case DELETE:
@@ -52,6 +64,38 @@ Message::Message(string message){
 		case READREPLY:
 			value = tuple.at(3);
 			break;
+		case MULTIPUT:
+			for (size_t i = 3; i + 5 <= tuple.size(); i += 5) {
+				batch.push_back(BatchEntry{static_cast<uint64_t>(stoull(tuple.at(i))), tuple.at(i + 1), tuple.at(i + 2),
+										   static_cast<ReplicaType>(stoi(tuple.at(i + 3))), false, tuple.at(i + 4)});
+			}
+			break;
+		case MULTIGET:
+			for (size_t i = 3; i + 2 <= tuple.size(); i += 2) {
+				batch.push_back(BatchEntry{static_cast<uint64_t>(stoull(tuple.at(i))), tuple.at(i + 1), "", PRIMARY, false});
+			}
+			break;
+		case MULTIREPLY:
+			for (size_t i = 3; i + 3 <= tuple.size(); i += 3) {
+				batch.push_back(BatchEntry{static_cast<uint64_t>(stoull(tuple.at(i))), "", tuple.at(i + 2), PRIMARY, tuple.at(i + 1) == "1"});
+			}
+			break;
+		case MERKLE:
+			for (size_t i = 3; i + 2 <= tuple.size(); i += 2) {
+				digests.push_back(make_pair(stoi(tuple.at(i)), static_cast<uint64_t>(stoull(tuple.at(i + 1)))));
+			}
+			break;
+		case STREAM:
+			sequence = stoi(tuple.at(3));
+			success = tuple.at(4) == "1";
+			for (size_t i = 5; i + 4 <= tuple.size(); i += 4) {
+				batch.push_back(BatchEntry{0, tuple.at(i), tuple.at(i + 1), static_cast<ReplicaType>(stoi(tuple.at(i + 2))), false,
+										   "", tuple.at(i + 3) == "1"});
+			}
+			break;
+		case STREAMACK:
+			sequence = stoi(tuple.at(3));
+			break;
 	}
 }
 
@@ -59,7 +103,7 @@ Message::Message(string message){
  * Constructor
  */
 // construct a create or update message
-Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key, string _value, ReplicaType _replica){
+Message::Message(uint64_t _transID, Address _fromAddr, MessageType _type, string _key, string _value, ReplicaType _replica){
 	this->delimiter = "::";
 	transID = _transID;
 	fromAddr = _fromAddr;
@@ -81,12 +125,16 @@ Message::Message(const Message& anotherMessage) {
 	this->transID = anotherMessage.transID;
 	this->type = anotherMessage.type;
 	this->value = anotherMessage.value;
+	this->batch = anotherMessage.batch;
+	this->hint = anotherMessage.hint;
+	this->digests = anotherMessage.digests;
+	this->sequence = anotherMessage.sequence;
 }
 
 /**
  * Constructor
  */
-Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key, string _value){
+Message::Message(uint64_t _transID, Address _fromAddr, MessageType _type, string _key, string _value){
 	this->delimiter = "::";
 	transID = _transID;
 	fromAddr = _fromAddr;
@@ -99,7 +147,7 @@ Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key
  * Constructor
  */
 // construct a read or delete message
-Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key){
+Message::Message(uint64_t _transID, Address _fromAddr, MessageType _type, string _key){
 	this->delimiter = "::";
 	transID = _transID;
 	fromAddr = _fromAddr;
@@ -111,7 +159,7 @@ Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key
  * Constructor
  */
 // construct reply message
-Message::Message(int _transID, Address _fromAddr, MessageType _type, bool _success){
+Message::Message(uint64_t _transID, Address _fromAddr, MessageType _type, bool _success){
 	this->delimiter = "::";
 	transID = _transID;
 	fromAddr = _fromAddr;
@@ -123,7 +171,7 @@ Message::Message(int _transID, Address _fromAddr, MessageType _type, bool _succe
  * Constructor
  */
 // construct read reply message
-Message::Message(int _transID, Address _fromAddr, string _value){
+Message::Message(uint64_t _transID, Address _fromAddr, string _value){
 	this->delimiter = "::";
 	transID = _transID;
 	fromAddr = _fromAddr;
@@ -131,6 +179,56 @@ Message::Message(int _transID, Address _fromAddr, string _value){
 	value = _value;
 }
 
+/**
+ * Constructor
+ */
+// construct batch message
+Message::Message(uint64_t _transID, Address _fromAddr, MessageType _type, vector<BatchEntry> _batch){
+	this->delimiter = "::";
+	transID = _transID;
+	fromAddr = _fromAddr;
+	type = _type;
+	batch = std::move(_batch);
+}
+
+/**
+ * Constructor
+ */
+// construct stream chunk message
+Message::Message(uint64_t _transID, Address _fromAddr, int _sequence, bool _last, vector<BatchEntry> _batch){
+	this->delimiter = "::";
+	transID = _transID;
+	fromAddr = _fromAddr;
+	type = STREAM;
+	sequence = _sequence;
+	success = _last;
+	batch = std::move(_batch);
+}
+
+/**
+ * Constructor
+ */
+// construct stream acknowledgement message
+Message::Message(uint64_t _transID, Address _fromAddr, int _sequence){
+	this->delimiter = "::";
+	transID = _transID;
+	fromAddr = _fromAddr;
+	type = STREAMACK;
+	sequence = _sequence;
+}
+
+/**
+ * Constructor
+ */
+// construct Merkle tree digest message
+Message::Message(uint64_t _transID, Address _fromAddr, vector<pair<int, uint64_t> > _digests){
+	this->delimiter = "::";
+	transID = _transID;
+	fromAddr = _fromAddr;
+	type = MERKLE;
+	digests = std::move(_digests);
+}
+
 /**
  * FUNCTION NAME: toString
  *
@@ -141,7 +239,11 @@ string Message::toString(){
 	switch(type){
 		case CREATE:
 		case UPDATE:
+		case TRANSFER:
+		case TRANSFERUPDATE:
 			message += key + delimiter + value + delimiter + to_string(replica);
+			if (!hint.empty())
+				message += delimiter + hint;
 			break;
 		case READ:
 		case DELETE:
@@ -156,6 +258,54 @@ string Message::toString(){
 		case READREPLY:
 			message += value;
 			break;
+		case STREAM:
+			message += to_string(sequence) + delimiter + (success ? "1" : "0");
+			for (size_t i = 0; i < batch.size(); ++i) {
+				message += delimiter + entryToString(batch[i]);
+			}
+			break;
+		case STREAMACK:
+			message += to_string(sequence);
+			break;
+		case MULTIPUT:
+		case MULTIGET:
+		case MULTIREPLY:
+			for (size_t i = 0; i < batch.size(); ++i) {
+				if (i > 0)
+					message += delimiter;
+				message += entryToString(batch[i]);
+			}
+			break;
+		case MERKLE:
+			for (size_t i = 0; i < digests.size(); ++i) {
+				if (i > 0)
+					message += delimiter;
+				message += to_string(digests[i].first) + delimiter + to_string(digests[i].second);
+			}
+			break;
+	}
+	return message;
+}
+
+/**
+ * FUNCTION NAME: entryToString
+ *
+ * DESCRIPTION: Serialized key of a batch message, in the format of the message type
+ */
+string Message::entryToString(const BatchEntry &entry){
+	if (type == STREAM)
+		return entry.key + delimiter + entry.value + delimiter + to_string(entry.replica) + delimiter + (entry.deleted ? "1" : "0");
+	string message = to_string(entry.transID) + delimiter;
+	switch(type){
+		case MULTIPUT:
+			message += entry.key + delimiter + entry.value + delimiter + to_string(entry.replica) + delimiter + entry.hint;
+			break;
+		case MULTIGET:
+			message += entry.key;
+			break;
+		default:
+			message += (entry.success ? "1" : "0") + delimiter + entry.value;
+			break;
 	}
 	return message;
 }
@@ -172,5 +322,9 @@ Message& Message::operator =(const Message& anotherMessage) {
 	this->transID = anotherMessage.transID;
 	this->type = anotherMessage.type;
 	this->value = anotherMessage.value;
+	this->batch = anotherMessage.batch;
+	this->hint = anotherMessage.hint;
+	this->digests = anotherMessage.digests;
+	this->sequence = anotherMessage.sequence;
 	return *this;
 }
@@ -10,6 +10,24 @@
 #include "Member.h"
 #include "common.h"
 
+/**
+ * STRUCT NAME: BatchEntry
+ *
+ * DESCRIPTION: One key of a MULTIPUT, MULTIGET or MULTIREPLY message, every key is a transaction of its own.
+ * 				A STREAM chunk carries the entries of the keys it transfers in value, without transID.
+ */
+struct BatchEntry {
+	uint64_t transID;
+	string key;
+	string value;
+	ReplicaType replica;
+	bool success;
+	// address of the replica a hinted write stands in for
+	string hint;
+	// a STREAM entry that is the tombstone of a deleted key, value holds the tick of the delete
+	bool deleted;
+};
+
 /**
  * CLASS NAME: Message
  *
@@ -22,25 +40,43 @@ public:
 	string key;
 	string value;
 	Address fromAddr;
-	int transID;
+	uint64_t transID;
 	bool success; // success or not 
+	// keys of a batch message
+	vector<BatchEntry> batch;
+	// address of the replica a hinted CREATE or UPDATE stands in for, empty if it is for the receiver
+	string hint;
+	// (index, hash) of the Merkle tree nodes of a MERKLE message, see MerkleTree.h
+	vector<pair<int, uint64_t> > digests;
+	// position of a STREAM chunk in the stream transID names, or of the last chunk in order a STREAMACK acknowledges
+	int sequence;
 	// delimiter
 	string delimiter;
 	// construct a message from a string
 	Message(string message);
 	Message(const Message& anotherMessage);
 	// construct a create or update message
-	Message(int _transID, Address _fromAddr, MessageType _type, string _key, string _value);
-	Message(int _transID, Address _fromAddr, MessageType _type, string _key, string _value, ReplicaType _replica);
+	Message(uint64_t _transID, Address _fromAddr, MessageType _type, string _key, string _value);
+	Message(uint64_t _transID, Address _fromAddr, MessageType _type, string _key, string _value, ReplicaType _replica);
 	// construct a read or delete message
-	Message(int _transID, Address _fromAddr, MessageType _type, string _key);
+	Message(uint64_t _transID, Address _fromAddr, MessageType _type, string _key);
 	// construct reply message
-	Message(int _transID, Address _fromAddr, MessageType _type, bool _success);
+	Message(uint64_t _transID, Address _fromAddr, MessageType _type, bool _success);
 	// construct read reply message
-	Message(int _transID, Address _fromAddr, string _value);
+	Message(uint64_t _transID, Address _fromAddr, string _value);
+	// construct batch message
+	Message(uint64_t _transID, Address _fromAddr, MessageType _type, vector<BatchEntry> _batch);
+	// construct stream chunk message, success marks the last chunk
+	Message(uint64_t _transID, Address _fromAddr, int _sequence, bool _last, vector<BatchEntry> _batch);
+	// construct stream acknowledgement message
+	Message(uint64_t _transID, Address _fromAddr, int _sequence);
+	// construct Merkle tree digest message
+	Message(uint64_t _transID, Address _fromAddr, vector<pair<int, uint64_t> > _digests);
 	Message& operator = (const Message& anotherMessage);
 	// serialize to a string
 	string toString();
+	// serialize one key of a batch message
+	string entryToString(const BatchEntry &entry);
 };
 
 #endif
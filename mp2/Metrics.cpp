@@ -0,0 +1,180 @@
+/**********************************
+ * FILE NAME: Metrics.cpp
+ *
+ * DESCRIPTION: Definition of Metrics class functions
+ **********************************/
+
+#include "Metrics.h"
+
+/**
+ * Constructor
+ */
+Metrics::Metrics(Params *par, Log *log) : par(par), log(log), bytes(0), messages(0), falsePositives(0) {}
+
+/**
+ * FUNCTION NAME: idOf
+ *
+ * DESCRIPTION: Id part of an address
+ */
+int Metrics::idOf(Address *addr) {
+    int id = 0;
+    memcpy(&id, &addr->addr[0], sizeof(int));
+    return id;
+}
+
+/**
+ * FUNCTION NAME: nodeStarted
+ *
+ * DESCRIPTION: The node starts joining the group now
+ */
+void Metrics::nodeStarted(Address *addr) {
+    int id = idOf(addr);
+    started.insert(id);
+    failed.erase(id);
+    lastJoin[id] = changes.size();
+    changes.push_back(Change{true, id, par->getcurrtime(), bytes, {}});
+}
+
+/**
+ * FUNCTION NAME: nodeFailed
+ *
+ * DESCRIPTION: The node fails (or leaves) now
+ */
+void Metrics::nodeFailed(Address *addr) {
+    int id = idOf(addr);
+    failed.insert(id);
+    lastFailure[id] = changes.size();
+    changes.push_back(Change{false, id, par->getcurrtime(), bytes, {}});
+}
+
+/**
+ * FUNCTION NAME: memberAdded
+ *
+ * DESCRIPTION: observer has added member to its membership list
+ */
+void Metrics::memberAdded(Address *observer, Address *member) {
+    auto it = lastJoin.find(idOf(member));
+    if (it != lastJoin.end()) {
+        observe(changes[it->second], idOf(observer));
+    }
+}
+
+/**
+ * FUNCTION NAME: memberRemoved
+ *
+ * DESCRIPTION: observer has removed member from its membership list
+ */
+void Metrics::memberRemoved(Address *observer, Address *member) {
+    int id = idOf(member);
+    if (!failed.count(id)) {
+        falsePositives++;
+        return;
+    }
+
+    observe(changes[lastFailure[id]], idOf(observer));
+}
+
+/**
+ * FUNCTION NAME: messageSent
+ *
+ * DESCRIPTION: A membership protocol message of size bytes was handed to the network
+ */
+void Metrics::messageSent(int size) {
+    bytes += size;
+    messages++;
+}
+
+/**
+ * FUNCTION NAME: observe
+ *
+ * DESCRIPTION: Records the first observation of the change by observer
+ */
+void Metrics::observe(Change &change, int observer) {
+    if (observer != change.node && !change.observations.count(observer)) {
+        change.observations[observer] = make_pair(par->getcurrtime(), bytes);
+    }
+}
+
+/**
+ * FUNCTION NAME: report
+ *
+ * DESCRIPTION: Writes the metrics of every change and a summary to the stats log.
+ * 				A change has converged once every node that is still alive at the end of the run
+ * 				has observed it.
+ */
+void Metrics::report() {
+    int converged[2] = {0, 0};
+    int count[2] = {0, 0};
+    int observed[2] = {0, 0};
+    long firstSum[2] = {0, 0};
+    long allSum[2] = {0, 0};
+    int allMax[2] = {0, 0};
+    long bytesSum[2] = {0, 0};
+
+    for (auto &change: changes) {
+        Address addr;
+        addr.init();
+        memcpy(&addr.addr[0], &change.node, sizeof(int));
+        const char *what = change.join ? "join" : "failure";
+        int k = change.join ? 0 : 1;
+        count[k]++;
+
+        int first = -1;
+        int all = change.time;
+        long bytesToConverge = 0;
+        bool done = true;
+        for (auto &observation: change.observations) {
+            if (first == -1 || observation.second.first < first) {
+                first = observation.second.first;
+            }
+        }
+        for (int node: started) {
+            if (node == change.node || failed.count(node)) {
+                continue;
+            }
+            auto it = change.observations.find(node);
+            if (it == change.observations.end()) {
+                done = false;
+                break;
+            }
+            if (it->second.first >= all) {
+                all = it->second.first;
+                bytesToConverge = it->second.second - change.bytesAtChange;
+            }
+        }
+
+        if (first == -1) {
+            log->LOG(&addr, "#STATSLOG# %s at time %d: not observed", what, change.time);
+            continue;
+        }
+        observed[k]++;
+        firstSum[k] += first - change.time;
+        if (!done) {
+            log->LOG(&addr, "#STATSLOG# %s at time %d: first observed after %d, not observed by all live nodes",
+                     what, change.time, first - change.time);
+            continue;
+        }
+
+        converged[k]++;
+        allSum[k] += all - change.time;
+        allMax[k] = max(allMax[k], all - change.time);
+        bytesSum[k] += bytesToConverge;
+        log->LOG(&addr, "#STATSLOG# %s at time %d: first observed after %d, observed by all live nodes after %d, gossip bytes %ld",
+                 what, change.time, first - change.time, all - change.time, bytesToConverge);
+    }
+
+    Address addr;
+    addr.init();
+    for (int k = 0; k < 2; ++k) {
+        const char *what = k == 0 ? "joins" : "failures";
+        if (converged[k] == 0) {
+            log->LOG(&addr, "#STATSLOG# %s: %d, converged 0", what, count[k]);
+            continue;
+        }
+        log->LOG(&addr, "#STATSLOG# %s: %d, converged %d, mean first observation %.2f, mean convergence %.2f, max convergence %d, mean gossip bytes %.0f",
+                 what, count[k], converged[k], (double) firstSum[k] / observed[k], (double) allSum[k] / converged[k],
+                 allMax[k], (double) bytesSum[k] / converged[k]);
+    }
+    log->LOG(&addr, "#STATSLOG# false positives: %d, membership messages: %ld, membership bytes: %ld",
+             falsePositives, messages, bytes);
+}
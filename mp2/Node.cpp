@@ -6,16 +6,40 @@
 
 #include "Node.h"
 
+/**
+ * FUNCTION NAME: hashBytes
+ *
+ * DESCRIPTION: Position of the given bytes on the 64 bit ring. FNV-1a over the bytes followed by the
+ * 				MurmurHash3 finalizer, which spreads the FNV state over all 64 bits. It only depends on
+ * 				the bytes, so placements are the same in every build and on every run.
+ */
+uint64_t hashBytes(const void *data, size_t size) {
+	auto bytes = static_cast<const unsigned char *>(data);
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
 /**
  * constructor
  */
-Node::Node() {}
+Node::Node(): token(0) {}
 
 /**
  * constructor
  */
-Node::Node(Address address) {
+Node::Node(Address address, int token) {
 	this->nodeAddress = address;
+	this->token = token;
 	computeHashCode();
 }
 
@@ -27,10 +51,18 @@ Node::~Node() {}
 /**
  * FUNCTION NAME: computeHashCode
  *
- * DESCRIPTION: This function computes the hash code of the node address
+ * DESCRIPTION: This function computes the hash code of the token of the node address,
+ * 				from the six address bytes followed by the token number as four little endian
+ * 				bytes, so that the ring is the same whatever the byte order of the host
  */
 void Node::computeHashCode() {
-	nodeHashCode = hashFunc(nodeAddress.addr)%RING_SIZE;
+	unsigned char bytes[sizeof(nodeAddress.addr) + 4];
+	memcpy(bytes, nodeAddress.addr, sizeof(nodeAddress.addr));
+	uint32_t tokenBits = static_cast<uint32_t>(token);
+	for ( int i = 0; i < 4; i++ ) {
+		bytes[sizeof(nodeAddress.addr) + i] = static_cast<unsigned char>(tokenBits >> (8 * i));
+	}
+	nodeHashCode = hashBytes(bytes, sizeof(bytes));
 }
 
 /**
@@ -38,6 +70,7 @@ void Node::computeHashCode() {
  */
 Node::Node(const Node& another) {
 	this->nodeAddress = another.nodeAddress;
+	this->token = another.token;
 	this->nodeHashCode = another.nodeHashCode;
 }
 
@@ -46,6 +79,7 @@ Node::Node(const Node& another) {
  */
 Node& Node::operator=(const Node& another) {
 	this->nodeAddress = another.nodeAddress;
+	this->token = another.token;
 	this->nodeHashCode = another.nodeHashCode;
 	return *this;
 }
@@ -62,7 +96,7 @@ bool Node::operator < (const Node& another) const {
  *
  * DESCRIPTION: return hash code of the node
  */
-size_t Node::getHashCode() {
+uint64_t Node::getHashCode() {
 	return nodeHashCode;
 }
 
@@ -80,7 +114,7 @@ Address * Node::getAddress() {
  *
  * DESCRIPTION: set the hash code of the node
  */
-void Node::setHashCode(size_t hashCode) {
+void Node::setHashCode(uint64_t hashCode) {
 	this->nodeHashCode = hashCode;
 }
 
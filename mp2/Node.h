@@ -10,20 +10,25 @@
 #include "stdincludes.h"
 #include "Member.h"
 
+#include <cstdint>
+
+uint64_t hashBytes(const void *data, size_t size);
+
 class Node {
 public:
 	Address nodeAddress;
-	size_t nodeHashCode;
-	std::hash<string> hashFunc;
+	// which of the tokens of the node this is
+	int token;
+	uint64_t nodeHashCode;
 	Node();
-	Node(Address address);
+	Node(Address address, int token = 0);
 	Node(const Node& another);
 	Node& operator=(const Node& another);
 	bool operator < (const Node& another) const;
 	void computeHashCode();
-	size_t getHashCode();
+	uint64_t getHashCode();
 	Address * getAddress();
-	void setHashCode(size_t hashCode);
+	void setHashCode(uint64_t hashCode);
 	void setAddress(Address address);
 	virtual ~Node();
 };
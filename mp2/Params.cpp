@@ -42,6 +42,52 @@ void Params::setparams(char *config_file) {
 
 	//printf("Parameters of the test case: %d %d %d %lf\n", MAX_NNB, SINGLE_FAILURE, DROP_MSG, MSG_DROP_PROB);
 
+	// optional settings, "NAME: value" per line in any order
+	NUM_SEEDS = 1;
+	GRACEFUL_LEAVE = 0;
+	VIRTUAL_NODES = 1;
+	REPLICATION_FACTOR = 3;
+	READ_QUORUM = 2;
+	WRITE_QUORUM = 2;
+	PLACEMENT = RING_PLACEMENT;
+	PLACEMENT_REPORT = 0;
+	char name[64];
+	char value[64];
+	while ( fscanf(fp, " %63[^:]: %63s", name, value) == 2 ) {
+		if ( 0 == strcmp(name, "NUM_SEEDS") ) {
+			NUM_SEEDS = atoi(value);
+		}
+		else if ( 0 == strcmp(name, "GRACEFUL_LEAVE") ) {
+			GRACEFUL_LEAVE = atoi(value);
+		}
+		else if ( 0 == strcmp(name, "VIRTUAL_NODES") ) {
+			VIRTUAL_NODES = atoi(value);
+		}
+		else if ( 0 == strcmp(name, "REPLICATION_FACTOR") ) {
+			REPLICATION_FACTOR = atoi(value);
+		}
+		else if ( 0 == strcmp(name, "READ_QUORUM") ) {
+			READ_QUORUM = atoi(value);
+		}
+		else if ( 0 == strcmp(name, "WRITE_QUORUM") ) {
+			WRITE_QUORUM = atoi(value);
+		}
+		else if ( 0 == strcmp(name, "PLACEMENT") ) {
+			if ( 0 == strcmp(value, "RENDEZVOUS") ) {
+				PLACEMENT = RENDEZVOUS_PLACEMENT;
+			}
+			else if ( 0 == strcmp(value, "JUMP") ) {
+				PLACEMENT = JUMP_PLACEMENT;
+			}
+			else {
+				PLACEMENT = RING_PLACEMENT;
+			}
+		}
+		else if ( 0 == strcmp(name, "PLACEMENT_REPORT") ) {
+			PLACEMENT_REPORT = atoi(value);
+		}
+	}
+
 	EN_GPSZ = MAX_NNB;
 	STEP_RATE=.25;
 	MAX_MSG_SIZE = 4000;
@@ -51,6 +97,11 @@ void Params::setparams(char *config_file) {
 	for ( unsigned int i = 0; i < EN_GPSZ; i++ ) {
 		allNodesJoined += i;
 	}
+	NUM_SEEDS = max(1, min(NUM_SEEDS, EN_GPSZ));
+	VIRTUAL_NODES = max(1, VIRTUAL_NODES);
+	REPLICATION_FACTOR = max(1, min(REPLICATION_FACTOR, EN_GPSZ));
+	READ_QUORUM = max(1, min(READ_QUORUM, REPLICATION_FACTOR));
+	WRITE_QUORUM = max(1, min(WRITE_QUORUM, REPLICATION_FACTOR));
 	fclose(fp);
 	//trace.funcExit("Params::setparams", SUCCESS);
 	return;
@@ -13,6 +13,8 @@
 
 enum testTYPE { CREATE_TEST, READ_TEST, UPDATE_TEST, DELETE_TEST };
 
+enum placementTYPE { RING_PLACEMENT, RENDEZVOUS_PLACEMENT, JUMP_PLACEMENT };
+
 /**
  * CLASS NAME: Params
  *
@@ -31,6 +33,14 @@ public:
 	int globaltime;
 	int allNodesJoined;
 	short PORTNUM;
+	int NUM_SEEDS;				// number of introducers, the nodes with ids 1..NUM_SEEDS
+	int GRACEFUL_LEAVE;			// failed nodes announce their leave instead of crashing
+	int VIRTUAL_NODES;			// tokens per node on the hash ring
+	int REPLICATION_FACTOR;		// N, replicas of every key
+	int READ_QUORUM;			// R, replies a read waits for
+	int WRITE_QUORUM;			// W, replies a create, update or delete waits for
+	int PLACEMENT;				// strategy that picks the replicas of a key, see Placement.h
+	int PLACEMENT_REPORT;		// compare the placement strategies in the stats log
 	int CRUDTEST;
 	Params();
 	void setparams(char *);
@@ -0,0 +1,552 @@
+/**********************************
+ * FILE NAME: Placement.cpp
+ *
+ * DESCRIPTION: Definition of the replica placement strategies
+ **********************************/
+
+#include "Placement.h"
+
+#include <chrono>
+
+/**
+ * FUNCTION NAME: addressKey
+ *
+ * DESCRIPTION: Orders addresses by id, then by port
+ */
+static uint64_t addressKey(const Address &address) {
+    int id = 0;
+    unsigned short port = 0;
+    memcpy(&id, &address.addr[0], sizeof(int));
+    memcpy(&port, &address.addr[4], sizeof(short));
+    return (static_cast<uint64_t>(static_cast<unsigned int>(id)) << 16) | port;
+}
+
+/**
+ * Constructor
+ */
+PlacementStrategy::PlacementStrategy(Params *par) : par(par) {}
+
+/**
+ * Destructor
+ */
+PlacementStrategy::~PlacementStrategy() {}
+
+/**
+ * FUNCTION NAME: addOnce
+ *
+ * DESCRIPTION: Appends a copy of the node unless a node with the same address is there already
+ */
+bool PlacementStrategy::addOnce(vector<Node> &nodes, Node *node) {
+    for (auto &known: nodes) {
+        if (*known.getAddress() == *node->getAddress()) {
+            return false;
+        }
+    }
+    nodes.push_back(*node);
+    return true;
+}
+
+/**
+ * FUNCTION NAME: create
+ *
+ * DESCRIPTION: Factory of the strategy selected by par->PLACEMENT
+ */
+PlacementStrategy *PlacementStrategy::create(int type, Params *par) {
+    switch (type) {
+        case RENDEZVOUS_PLACEMENT:
+            return new RendezvousPlacement(par);
+        case JUMP_PLACEMENT:
+            return new JumpPlacement(par);
+        default:
+            return new RingPlacement(par);
+    }
+}
+
+/**
+ * FUNCTION NAME: compare
+ *
+ * DESCRIPTION: Places the same sample of keys with every strategy on a group of par->EN_GPSZ nodes
+ * 				and writes to the stats log:
+ * 				1) the load balance, the most loaded node relative to the mean, for primaries and
+ * 				   for all replicas
+ * 				2) the fraction of replica assignments that move when the node in the middle of the
+ * 				   group leaves, and when a node with a new id joins. Each change has to move at
+ * 				   least the share of the changed node, which is given as the ideal
+ * 				3) the time of a lookup
+ */
+void PlacementStrategy::compare(Params *par, Log *log) {
+    const int keys = 10000;
+    int n = par->EN_GPSZ;
+    auto addressOf = [par](int id) {
+        Address address;
+        memcpy(&address.addr[0], &id, sizeof(int));
+        memcpy(&address.addr[4], &par->PORTNUM, sizeof(short));
+        return address;
+    };
+    auto idOf = [](Node *node) {
+        int id = 0;
+        memcpy(&id, &node->getAddress()->addr[0], sizeof(int));
+        return id;
+    };
+
+    vector<uint64_t> hashes;
+    for (int i = 0; i < keys; ++i) {
+        string key = "key" + to_string(i);
+        hashes.push_back(hashBytes(key.data(), key.size()));
+    }
+
+    // ids of the replicas of every key, empty if the strategy has too few nodes
+    auto place = [&](PlacementStrategy *placement) {
+        vector<vector<int>> assignments(keys);
+        for (int i = 0; i < keys; ++i) {
+            for (auto node: placement->findNodes(hashes[i])) {
+                assignments[i].push_back(idOf(node));
+            }
+        }
+        return assignments;
+    };
+    auto moved = [&](const vector<vector<int>> &before, const vector<vector<int>> &after) {
+        long total = 0;
+        long count = 0;
+        for (int i = 0; i < keys; ++i) {
+            if (before[i].empty() || after[i].empty()) {
+                return -1.0;
+            }
+            for (int id: after[i]) {
+                count += find(before[i].begin(), before[i].end(), id) == before[i].end();
+            }
+            total += after[i].size();
+        }
+        return (double) count / total;
+    };
+
+    Address addr;
+    addr.init();
+    for (int type = RING_PLACEMENT; type <= JUMP_PLACEMENT; ++type) {
+        PlacementStrategy *placement = create(type, par);
+        for (int id = 1; id <= n; ++id) {
+            placement->addNode(addressOf(id));
+        }
+        placement->rebuild();
+
+        auto start = std::chrono::steady_clock::now();
+        vector<vector<int>> before = place(placement);
+        auto end = std::chrono::steady_clock::now();
+        double lookup = std::chrono::duration<double, std::nano>(end - start).count() / keys;
+
+        if (before[0].empty()) {
+            log->LOG(&addr, "#STATSLOG# placement %s: fewer than %d nodes", placement->name(), par->REPLICATION_FACTOR);
+            delete placement;
+            continue;
+        }
+
+        vector<long> primaries(n + 2, 0);
+        vector<long> replicas(n + 2, 0);
+        for (auto &ids: before) {
+            primaries[ids[0]]++;
+            for (int id: ids) {
+                replicas[id]++;
+            }
+        }
+        double primaryMean = (double) keys / n;
+        double replicaMean = (double) keys * before[0].size() / n;
+
+        Address leaving = addressOf(n / 2 + 1);
+        placement->removeNode(leaving);
+        placement->rebuild();
+        double movedOnLeave = moved(before, place(placement));
+        placement->addNode(leaving);
+        placement->addNode(addressOf(n + 1));
+        placement->rebuild();
+        double movedOnJoin = moved(before, place(placement));
+
+        log->LOG(&addr, "#STATSLOG# placement %s: %d nodes, %d keys, max/mean load %.3f primaries, %.3f replicas, "
+                        "moved on leave %.3f (ideal %.3f), moved on join %.3f (ideal %.3f), lookup %.0f ns",
+                 placement->name(), n, keys,
+                 *max_element(primaries.begin(), primaries.end()) / primaryMean,
+                 *max_element(replicas.begin(), replicas.end()) / replicaMean,
+                 movedOnLeave, 1.0 / n, movedOnJoin, 1.0 / (n + 1), lookup);
+        delete placement;
+    }
+}
+
+/**
+ * Constructor
+ */
+RingPlacement::RingPlacement(Params *par) : PlacementStrategy(par) {}
+
+const char *RingPlacement::name() {
+    return "ring";
+}
+
+/**
+ * FUNCTION NAME: addNode
+ *
+ * DESCRIPTION: Inserts the VIRTUAL_NODES tokens of the node at their positions on the ring
+ */
+bool RingPlacement::addNode(const Address &address) {
+    if (findToken(Node(address, 0)) != ring.end()) {
+        return false;
+    }
+
+    for (int token = 0; token < par->VIRTUAL_NODES; ++token) {
+        Node node(address, token);
+        ring.emplace(node.getHashCode(), node);
+    }
+    return true;
+}
+
+/**
+ * FUNCTION NAME: removeNode
+ *
+ * DESCRIPTION: Removes all the tokens of the node from the ring
+ */
+bool RingPlacement::removeNode(const Address &address) {
+    bool removed = false;
+    for (int token = 0; token < par->VIRTUAL_NODES; ++token) {
+        auto it = findToken(Node(address, token));
+        if (it != ring.end()) {
+            ring.erase(it);
+            removed = true;
+        }
+    }
+
+    return removed;
+}
+
+/**
+ * FUNCTION NAME: findToken
+ *
+ * DESCRIPTION: Looks the token up by its hash code, the address tells colliding tokens apart
+ *
+ * RETURNS:
+ * The position of the token in the ring, or ring.end()
+ */
+multimap<uint64_t, Node>::iterator RingPlacement::findToken(Node node) {
+    auto range = ring.equal_range(node.getHashCode());
+    for (auto it = range.first; it != range.second; ++it) {
+        if (*it->second.getAddress() == *node.getAddress() && it->second.token == node.token) {
+            return it;
+        }
+    }
+
+    return ring.end();
+}
+
+size_t RingPlacement::nodeCount() {
+    return ring.size() / par->VIRTUAL_NODES;
+}
+
+/**
+ * FUNCTION NAME: rebuild
+ *
+ * DESCRIPTION: Materializes the replicas of every arc of the ring: the first par->REPLICATION_FACTOR
+ * 				distinct nodes met walking the ring clockwise from the token that ends the arc.
+ * 				Tokens of a node that has already been picked are skipped.
+ * 				There are no lists while the ring has fewer than par->REPLICATION_FACTOR nodes.
+ */
+void RingPlacement::rebuild() {
+    arcEnds.clear();
+    preferenceLists.clear();
+    auto replicationFactor = static_cast<size_t>(par->REPLICATION_FACTOR);
+    if (nodeCount() < replicationFactor) {
+        return;
+    }
+
+    arcEnds.reserve(ring.size());
+    preferenceLists.reserve(ring.size());
+    for (auto end = ring.begin(); end != ring.end(); ++end) {
+        arcEnds.push_back(end->first);
+        preferenceLists.emplace_back();
+        vector<Node *> &replicas = preferenceLists.back();
+
+        auto it = end;
+        for (size_t i = 0; i < ring.size() && replicas.size() < replicationFactor; ++i, ++it) {
+            if (it == ring.end()) {
+                it = ring.begin();
+            }
+            Node *token = &it->second;
+            bool picked = false;
+            for (auto replica: replicas) {
+                picked |= *replica->getAddress() == *token->getAddress();
+            }
+            if (!picked) {
+                replicas.push_back(token);
+            }
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: findNodes
+ *
+ * DESCRIPTION: The preference list of the arc the position of the key falls in
+ */
+const vector<Node *> &RingPlacement::findNodes(uint64_t keyHash) {
+    static const vector<Node *> noReplicas;
+    if (preferenceLists.empty()) {
+        return noReplicas;
+    }
+
+    size_t arc = lower_bound(arcEnds.begin(), arcEnds.end(), keyHash) - arcEnds.begin();
+    return preferenceLists[arc == arcEnds.size() ? 0 : arc];
+}
+
+/**
+ * FUNCTION NAME: findSuccessors
+ *
+ * DESCRIPTION: Walks the ring clockwise from the position of the key, skipping the tokens of nodes
+ * 				that have already been picked
+ */
+void RingPlacement::findSuccessors(uint64_t keyHash, size_t count, vector<Node *> &successors) {
+    successors.clear();
+    auto it = ring.lower_bound(keyHash);
+    for (size_t i = 0; i < ring.size() && successors.size() < count; ++i, ++it) {
+        if (it == ring.end()) {
+            it = ring.begin();
+        }
+        Node *token = &it->second;
+        bool picked = false;
+        for (auto successor: successors) {
+            picked |= *successor->getAddress() == *token->getAddress();
+        }
+        if (!picked) {
+            successors.push_back(token);
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: findNeighbors
+ *
+ * DESCRIPTION: Derives the replication neighbours of self from the preference lists
+ */
+void RingPlacement::findNeighbors(const Address &self, vector<Node> &hasMyReplicas, vector<Node> &haveReplicasOf) {
+    Address me = self;
+    for (auto &replicas: preferenceLists) {
+        if (*replicas[0]->getAddress() == me) {
+            for (size_t i = 1; i < replicas.size(); ++i) {
+                addOnce(hasMyReplicas, replicas[i]);
+            }
+            continue;
+        }
+        for (size_t i = 1; i < replicas.size(); ++i) {
+            if (*replicas[i]->getAddress() == me) {
+                addOnce(haveReplicasOf, replicas[0]);
+            }
+        }
+    }
+}
+
+/**
+ * Constructor
+ */
+ListPlacement::ListPlacement(Params *par) : PlacementStrategy(par) {}
+
+/**
+ * FUNCTION NAME: lowerBound
+ *
+ * DESCRIPTION: First node of the sorted list whose address is not less than the given one
+ */
+vector<Node>::iterator ListPlacement::lowerBound(const Address &address) {
+    uint64_t key = addressKey(address);
+    return lower_bound(nodes.begin(), nodes.end(), key, [](Node &node, uint64_t key) {
+        return addressKey(*node.getAddress()) < key;
+    });
+}
+
+/**
+ * FUNCTION NAME: addNode
+ *
+ * DESCRIPTION: Inserts the node into the sorted list
+ */
+bool ListPlacement::addNode(const Address &address) {
+    auto it = lowerBound(address);
+    if (it != nodes.end() && addressKey(*it->getAddress()) == addressKey(address)) {
+        return false;
+    }
+
+    nodes.insert(it, Node(address));
+    return true;
+}
+
+/**
+ * FUNCTION NAME: removeNode
+ *
+ * DESCRIPTION: Removes the node from the sorted list
+ */
+bool ListPlacement::removeNode(const Address &address) {
+    auto it = lowerBound(address);
+    if (it == nodes.end() || addressKey(*it->getAddress()) != addressKey(address)) {
+        return false;
+    }
+
+    nodes.erase(it);
+    return true;
+}
+
+/**
+ * FUNCTION NAME: rebuild
+ *
+ * DESCRIPTION: The list is kept sorted as it changes, only the replicas of the last lookup are stale
+ */
+void ListPlacement::rebuild() {
+    replicas.clear();
+}
+
+size_t ListPlacement::nodeCount() {
+    return nodes.size();
+}
+
+/**
+ * Constructor
+ */
+RendezvousPlacement::RendezvousPlacement(Params *par) : ListPlacement(par) {}
+
+const char *RendezvousPlacement::name() {
+    return "rendezvous";
+}
+
+/**
+ * FUNCTION NAME: findNodes
+ *
+ * DESCRIPTION: Scores every node with the hash of the key and the node, in O(n)
+ */
+const vector<Node *> &RendezvousPlacement::findNodes(uint64_t keyHash) {
+    replicas.clear();
+    auto replicationFactor = static_cast<size_t>(par->REPLICATION_FACTOR);
+    if (nodes.size() < replicationFactor) {
+        return replicas;
+    }
+
+    findSuccessors(keyHash, replicationFactor, replicas);
+    return replicas;
+}
+
+/**
+ * FUNCTION NAME: findSuccessors
+ *
+ * DESCRIPTION: The nodes with the count highest scores for the key, highest first. A score hashes
+ * 				the key hash and the node hash as eight little endian bytes each, so that the choice
+ * 				is the same whatever the byte order of the host.
+ */
+void RendezvousPlacement::findSuccessors(uint64_t keyHash, size_t count, vector<Node *> &successors) {
+    successors.clear();
+    count = min(count, nodes.size());
+    scores.clear();
+    unsigned char bytes[16];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<unsigned char>(keyHash >> (8 * i));
+    }
+    for (auto &node: nodes) {
+        uint64_t nodeHash = node.getHashCode();
+        for (int i = 0; i < 8; ++i) {
+            bytes[8 + i] = static_cast<unsigned char>(nodeHash >> (8 * i));
+        }
+        scores.emplace_back(hashBytes(bytes, sizeof(bytes)), &node);
+    }
+    partial_sort(scores.begin(), scores.begin() + count, scores.end(),
+                 [](const pair<uint64_t, Node *> &a, const pair<uint64_t, Node *> &b) {
+                     return a.first > b.first;
+                 });
+    for (size_t i = 0; i < count; ++i) {
+        successors.push_back(scores[i].second);
+    }
+}
+
+/**
+ * FUNCTION NAME: findNeighbors
+ *
+ * DESCRIPTION: Any two nodes share keys, so every other node is a neighbour both ways
+ */
+void RendezvousPlacement::findNeighbors(const Address &self, vector<Node> &hasMyReplicas, vector<Node> &haveReplicasOf) {
+    if (par->REPLICATION_FACTOR < 2 || nodes.size() < static_cast<size_t>(par->REPLICATION_FACTOR)) {
+        return;
+    }
+
+    for (auto &node: nodes) {
+        if (addressKey(*node.getAddress()) != addressKey(self)) {
+            addOnce(hasMyReplicas, &node);
+            addOnce(haveReplicasOf, &node);
+        }
+    }
+}
+
+/**
+ * Constructor
+ */
+JumpPlacement::JumpPlacement(Params *par) : ListPlacement(par) {}
+
+const char *JumpPlacement::name() {
+    return "jump";
+}
+
+/**
+ * FUNCTION NAME: jumpHash
+ *
+ * DESCRIPTION: Bucket of the key among the given number of buckets
+ */
+int JumpPlacement::jumpHash(uint64_t key, int buckets) {
+    int64_t b = -1;
+    int64_t j = 0;
+    while (j < buckets) {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = static_cast<int64_t>((b + 1) * (static_cast<double>(1LL << 31) / static_cast<double>((key >> 33) + 1)));
+    }
+    return static_cast<int>(b);
+}
+
+/**
+ * FUNCTION NAME: findNodes
+ *
+ * DESCRIPTION: The bucket of the key and the buckets following it
+ */
+const vector<Node *> &JumpPlacement::findNodes(uint64_t keyHash) {
+    replicas.clear();
+    auto replicationFactor = static_cast<size_t>(par->REPLICATION_FACTOR);
+    if (nodes.size() < replicationFactor) {
+        return replicas;
+    }
+
+    findSuccessors(keyHash, replicationFactor, replicas);
+    return replicas;
+}
+
+/**
+ * FUNCTION NAME: findSuccessors
+ *
+ * DESCRIPTION: The bucket of the key and the count - 1 buckets following it
+ */
+void JumpPlacement::findSuccessors(uint64_t keyHash, size_t count, vector<Node *> &successors) {
+    successors.clear();
+    if (nodes.empty()) {
+        return;
+    }
+
+    size_t bucket = jumpHash(keyHash, static_cast<int>(nodes.size()));
+    for (size_t i = 0; i < min(count, nodes.size()); ++i) {
+        successors.push_back(&nodes[(bucket + i) % nodes.size()]);
+    }
+}
+
+/**
+ * FUNCTION NAME: findNeighbors
+ *
+ * DESCRIPTION: The par->REPLICATION_FACTOR - 1 buckets after self replicate its keys, self
+ * 				replicates the keys of as many buckets before it
+ */
+void JumpPlacement::findNeighbors(const Address &self, vector<Node> &hasMyReplicas, vector<Node> &haveReplicasOf) {
+    size_t n = nodes.size();
+    auto it = lowerBound(self);
+    if (n < static_cast<size_t>(par->REPLICATION_FACTOR) || it == nodes.end()
+        || addressKey(*it->getAddress()) != addressKey(self)) {
+        return;
+    }
+
+    size_t me = it - nodes.begin();
+    for (size_t i = 1; i < static_cast<size_t>(par->REPLICATION_FACTOR); ++i) {
+        addOnce(hasMyReplicas, &nodes[(me + i) % n]);
+        addOnce(haveReplicasOf, &nodes[(me + n - i) % n]);
+    }
+}
@@ -0,0 +1,173 @@
+/**********************************
+ * FILE NAME: Placement.h
+ *
+ * DESCRIPTION: Header file of the replica placement strategies
+ **********************************/
+
+#ifndef PLACEMENT_H_
+#define PLACEMENT_H_
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+#include "Node.h"
+#include "Log.h"
+
+/**
+ * CLASS NAME: PlacementStrategy
+ *
+ * DESCRIPTION: Decides which nodes replicate a key. Every node keeps its own instance and feeds it
+ * 				the membership changes, so the strategy only depends on the set of nodes, never on
+ * 				the order the changes arrived in. After a change rebuild() has to run before the
+ * 				next lookup.
+ */
+class PlacementStrategy {
+protected:
+    Params *par;
+
+    static bool addOnce(vector<Node> &nodes, Node *node);
+
+public:
+    PlacementStrategy(Params *par);
+
+    virtual ~PlacementStrategy();
+
+    virtual const char *name() = 0;
+
+    // true if the set of nodes has changed
+    virtual bool addNode(const Address &address) = 0;
+
+    virtual bool removeNode(const Address &address) = 0;
+
+    virtual void rebuild() = 0;
+
+    virtual size_t nodeCount() = 0;
+
+    // the par->REPLICATION_FACTOR replicas of the key, primary first. Empty while there are fewer
+    // nodes than that. Valid until the next lookup or change
+    virtual const vector<Node *> &findNodes(uint64_t keyHash) = 0;
+
+    // the first count distinct nodes in the order the strategy prefers them for the key, so the
+    // replicas come first and the nodes that would take over from them follow
+    virtual void findSuccessors(uint64_t keyHash, size_t count, vector<Node *> &successors) = 0;
+
+    // the nodes that replicate keys self is the primary of, and the primaries of keys self replicates
+    virtual void findNeighbors(const Address &self, vector<Node> &hasMyReplicas, vector<Node> &haveReplicasOf) = 0;
+
+    static PlacementStrategy *create(int type, Params *par);
+
+    static void compare(Params *par, Log *log);
+};
+
+/**
+ * CLASS NAME: RingPlacement
+ *
+ * DESCRIPTION: Consistent hashing. Every node owns par->VIRTUAL_NODES tokens on the ring, a key is
+ * 				replicated by the first par->REPLICATION_FACTOR distinct nodes met walking the ring
+ * 				clockwise from its position. The replicas of every arc are precomputed, so a lookup
+ * 				is a binary search.
+ */
+class RingPlacement : public PlacementStrategy {
+private:
+    // Ring of the tokens of all nodes, keyed by hash code
+    multimap<uint64_t, Node> ring;
+    // Preference lists of the ring arcs, rebuilt whenever the ring changes. Arc i ends at the token
+    // arcEnds[i] and starts right after arcEnds[i - 1], arc 0 also takes the wrap-around
+    vector<uint64_t> arcEnds;
+    vector<vector<Node *>> preferenceLists;
+
+    multimap<uint64_t, Node>::iterator findToken(Node node);
+
+public:
+    RingPlacement(Params *par);
+
+    const char *name() override;
+
+    bool addNode(const Address &address) override;
+
+    bool removeNode(const Address &address) override;
+
+    void rebuild() override;
+
+    size_t nodeCount() override;
+
+    const vector<Node *> &findNodes(uint64_t keyHash) override;
+
+    void findSuccessors(uint64_t keyHash, size_t count, vector<Node *> &successors) override;
+
+    void findNeighbors(const Address &self, vector<Node> &hasMyReplicas, vector<Node> &haveReplicasOf) override;
+};
+
+/**
+ * CLASS NAME: ListPlacement
+ *
+ * DESCRIPTION: Base of the strategies that place keys on the list of nodes sorted by address
+ */
+class ListPlacement : public PlacementStrategy {
+protected:
+    vector<Node> nodes;
+    // replicas of the last lookup
+    vector<Node *> replicas;
+
+    vector<Node>::iterator lowerBound(const Address &address);
+
+public:
+    ListPlacement(Params *par);
+
+    bool addNode(const Address &address) override;
+
+    bool removeNode(const Address &address) override;
+
+    void rebuild() override;
+
+    size_t nodeCount() override;
+};
+
+/**
+ * CLASS NAME: RendezvousPlacement
+ *
+ * DESCRIPTION: Highest random weight hashing. Every node scores the key with a hash of the key and
+ * 				the node, the par->REPLICATION_FACTOR highest scores replicate it. A change only moves
+ * 				the keys the changed node replicates, but a lookup scores every node.
+ */
+class RendezvousPlacement : public ListPlacement {
+private:
+    vector<pair<uint64_t, Node *>> scores;
+
+public:
+    RendezvousPlacement(Params *par);
+
+    const char *name() override;
+
+    const vector<Node *> &findNodes(uint64_t keyHash) override;
+
+    void findSuccessors(uint64_t keyHash, size_t count, vector<Node *> &successors) override;
+
+    void findNeighbors(const Address &self, vector<Node> &hasMyReplicas, vector<Node> &haveReplicasOf) override;
+};
+
+/**
+ * CLASS NAME: JumpPlacement
+ *
+ * DESCRIPTION: Jump consistent hashing (Lamping and Veach). The key jumps to one of the buckets
+ * 				0..n-1 of the sorted node list in O(log n) without any state, the following
+ * 				par->REPLICATION_FACTOR - 1 buckets hold the other replicas. Jump hashing only moves
+ * 				the minimum when the last bucket comes or goes, which is what a join of a node with
+ * 				a new, higher id does. Any other leave shifts every bucket after it.
+ */
+class JumpPlacement : public ListPlacement {
+public:
+    JumpPlacement(Params *par);
+
+    const char *name() override;
+
+    static int jumpHash(uint64_t key, int buckets);
+
+    const vector<Node *> &findNodes(uint64_t keyHash) override;
+
+    void findSuccessors(uint64_t keyHash, size_t count, vector<Node *> &successors) override;
+
+    void findNeighbors(const Address &self, vector<Node> &hasMyReplicas, vector<Node> &haveReplicasOf) override;
+};
+
+#endif /* PLACEMENT_H_ */
@@ -0,0 +1,59 @@
+/**********************************
+ * FILE NAME: TimerWheel.h
+ *
+ * DESCRIPTION: Hashed timing wheel used to expire deadlines
+ * 				without scanning every armed timer on each tick
+ **********************************/
+
+#ifndef TIMERWHEEL_H_
+#define TIMERWHEEL_H_
+
+#include "stdincludes.h"
+
+#include <unordered_map>
+
+using std::unordered_map;
+
+/**
+ * CLASS NAME: TimerWheel
+ *
+ * DESCRIPTION: Timers are keyed by a caller supplied 64 bit id and hashed into
+ * 				slot (deadline % slotCount). Advancing the wheel only visits
+ * 				the slots of the elapsed ticks, so the cost of a tick is
+ * 				proportional to the number of timers that are due, not to
+ * 				the number of timers that are armed.
+ * 				A key has at most one pending timer; scheduling it again re-arms it.
+ */
+class TimerWheel {
+private:
+    struct Timer {
+        uint64_t key;
+        long deadline;
+    };
+
+    vector<vector<Timer>> slots;
+    // key -> (slot, position inside the slot)
+    unordered_map<uint64_t, pair<size_t, size_t>> timers;
+    size_t mask;
+    // last tick that has been fully processed
+    long currentTick;
+
+    void removeAt(size_t slot, size_t position);
+
+public:
+    explicit TimerWheel(size_t slotCount = 32);
+
+    void reset(long tick);
+
+    void schedule(uint64_t key, long deadline);
+
+    bool cancel(uint64_t key);
+
+    bool isScheduled(uint64_t key) const;
+
+    size_t size() const;
+
+    void advance(long now, vector<uint64_t> &expired);
+};
+
+#endif /* TIMERWHEEL_H_ */
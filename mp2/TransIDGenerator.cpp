@@ -0,0 +1,34 @@
+/**********************************
+ * FILE NAME: TransIDGenerator.cpp
+ *
+ * DESCRIPTION: Definition of TransIDGenerator class functions
+ **********************************/
+
+#include "TransIDGenerator.h"
+
+/**
+ * Constructor
+ */
+TransIDGenerator::TransIDGenerator(int nodeId)
+        : node(static_cast<uint64_t>(nodeId) << (EPOCH_BITS + COUNTER_BITS)), sequence(0) {}
+
+/**
+ * FUNCTION NAME: restart
+ *
+ * DESCRIPTION: Moves to the given epoch with the counter back at 0
+ */
+void TransIDGenerator::restart(unsigned long epoch) {
+    sequence.store((static_cast<uint64_t>(epoch) & ((1ULL << EPOCH_BITS) - 1)) << COUNTER_BITS,
+                   std::memory_order_relaxed);
+}
+
+/**
+ * FUNCTION NAME: next
+ *
+ * DESCRIPTION: Returns a new transaction id, one atomic increment
+ */
+uint64_t TransIDGenerator::next() {
+    uint64_t mask = (1ULL << (EPOCH_BITS + COUNTER_BITS)) - 1;
+    return node | (sequence.fetch_add(1, std::memory_order_relaxed) & mask);
+}
+
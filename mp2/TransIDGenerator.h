@@ -0,0 +1,42 @@
+/**********************************
+ * FILE NAME: TransIDGenerator.h
+ *
+ * DESCRIPTION: Cluster wide unique transaction ids
+ **********************************/
+
+#ifndef TRANSIDGENERATOR_H_
+#define TRANSIDGENERATOR_H_
+
+#include "stdincludes.h"
+
+#include <atomic>
+
+/**
+ * CLASS NAME: TransIDGenerator
+ *
+ * DESCRIPTION: Hands out the transaction ids of one node. An id holds the node id in its top 16 bits,
+ * 				the epoch the node started in in the next 16 bits and a counter in the low 32 bits, so
+ * 				the ids of two nodes never collide and a node that starts over does not reuse the ids
+ * 				of its previous run. Epoch and counter share one atomic word, a counter that wraps
+ * 				carries over into the epoch. next() may be called from several threads at once,
+ * 				restart() only while no other thread is handing out ids.
+ */
+class TransIDGenerator {
+private:
+    uint64_t node;
+    std::atomic<uint64_t> sequence;
+
+public:
+    static const int NODE_BITS = 16;
+    static const int EPOCH_BITS = 16;
+    static const int COUNTER_BITS = 32;
+
+    explicit TransIDGenerator(int nodeId);
+
+    // starts the counter over in a new epoch, e.g. the time the node started
+    void restart(unsigned long epoch);
+
+    uint64_t next();
+};
+
+#endif /* TRANSIDGENERATOR_H_ */
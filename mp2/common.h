@@ -1,15 +1,10 @@
 #ifndef COMMON_H_
 #define COMMON_H_
 
-/**
- * Global variable
- */
-// Transaction Id
-static int g_transID = 0;
-
 // message types, reply is the message from node to coordinator
-enum MessageType {CREATE, READ, UPDATE, DELETE, REPLY, READREPLY};
-// enum of replica types
-enum ReplicaType {PRIMARY, SECONDARY, TERTIARY};
+enum MessageType {CREATE, READ, UPDATE, DELETE, REPLY, READREPLY, TRANSFER, MULTIPUT, MULTIGET, MULTIREPLY, MERKLE, STREAM, STREAMACK, TRANSFERUPDATE};
+// enum of replica types, the i-th replica of a preference list has type i.
+// Only the first three are named, the fixed underlying type makes the others valid too
+enum ReplicaType : int {PRIMARY, SECONDARY, TERTIARY};
 
 #endif
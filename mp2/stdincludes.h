@@ -10,7 +10,6 @@
 /*
  * Macros
  */
-#define RING_SIZE 512
 #define FAILURE -1
 #define SUCCESS 0
 